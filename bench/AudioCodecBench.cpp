@@ -0,0 +1,88 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include "AudioCodec.h"
+#include <QRandomGenerator>
+#include <cmath>
+
+namespace {
+
+constexpr int ITERATIONS = 20;
+constexpr int SAMPLE_RATE = 16000;
+constexpr int AUDIO_SECONDS = 10;
+constexpr int FRAME_SAMPLES = SAMPLE_RATE / 10; // 100 ms, as streamed
+
+// Voiced speech stand-in: a few harmonics with a syllable-rate envelope
+std::vector<std::int16_t> makeSpeech() {
+    std::vector<std::int16_t> samples(SAMPLE_RATE * AUDIO_SECONDS);
+    QRandomGenerator random(11);
+
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const double t = double(i) / SAMPLE_RATE;
+        const double envelope = 0.5 + 0.5 * std::sin(2.0 * M_PI * 4.0 * t);
+        const double voice = 0.5 * std::sin(2.0 * M_PI * 140.0 * t) +
+                             0.25 * std::sin(2.0 * M_PI * 280.0 * t) +
+                             0.12 * std::sin(2.0 * M_PI * 1150.0 * t);
+        const double noise = 0.02 * (random.generateDouble() - 0.5);
+        samples[i] = std::int16_t(std::lround((envelope * voice * 0.6 + noise) * 32767));
+    }
+    return samples;
+}
+
+} // namespace
+
+void runAudioCodecBench() {
+    const std::vector<std::int16_t> speech = makeSpeech();
+
+    for (AudioCodec codec : {AudioCodec::Pcm16, AudioCodec::MuLaw, AudioCodec::ImaAdpcm}) {
+        AudioEncoder encoder(codec);
+        std::vector<std::uint8_t> message;
+        std::uint64_t wireBytes = 0;
+
+        const bench::Stats encodeStats = bench::measure(ITERATIONS, [&]() {
+            encoder.reset();
+            wireBytes = 0;
+            for (std::size_t offset = 0; offset < speech.size(); offset += FRAME_SAMPLES) {
+                encoder.encode(speech.data() + offset, FRAME_SAMPLES, message);
+                wireBytes += message.size();
+            }
+        });
+
+        // Decode frame by frame and measure the quality loss
+        std::vector<std::vector<std::uint8_t>> messages;
+        encoder.reset();
+        for (std::size_t offset = 0; offset < speech.size(); offset += FRAME_SAMPLES) {
+            encoder.encode(speech.data() + offset, FRAME_SAMPLES, message);
+            messages.push_back(message);
+        }
+
+        std::vector<std::int16_t> decoded;
+        double signal = 0.0;
+        double error = 0.0;
+        const bench::Stats decodeStats = bench::measure(ITERATIONS, [&]() {
+            signal = 0.0;
+            error = 0.0;
+            std::size_t offset = 0;
+            for (const auto& encoded : messages) {
+                AudioDecoder::decode(codec, encoded.data(), encoded.size(), decoded);
+                for (std::size_t i = 0; i < decoded.size(); ++i, ++offset) {
+                    const double reference = speech[offset];
+                    signal += reference * reference;
+                    error += (reference - decoded[i]) * (reference - decoded[i]);
+                }
+            }
+        });
+
+        const QString name = QString::fromLatin1(audioCodecName(codec));
+        const double pcmBytes = double(speech.size() * sizeof(std::int16_t));
+        bench::report("audio_codec", name + "/encode", encodeStats, {
+            {"audio_seconds", AUDIO_SECONDS},
+            {"wire_bytes", qint64(wireBytes)},
+            {"compression_ratio", pcmBytes / wireBytes},
+            {"kbit_per_s", wireBytes * 8.0 / AUDIO_SECONDS / 1000.0},
+            {"cpu_percent_realtime", encodeStats.p50Us / (AUDIO_SECONDS * 1e6) * 100.0}
+        });
+        bench::report("audio_codec", name + "/decode", decodeStats, {
+            {"snr_db", error > 0 ? 10.0 * std::log10(signal / error) : 999.0}
+        });
+    }
+}
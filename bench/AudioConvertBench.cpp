@@ -0,0 +1,117 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include "AudioConverter.h"
+#include <QRandomGenerator>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int ITERATIONS = 10;
+constexpr int AUDIO_SECONDS = 10;
+constexpr int CHUNK_MS = 100; // QAudioSource buffer size used by AudioStreamer
+
+// A voice-band tone with some noise, interleaved across all channels
+QByteArray makeAudio(const PcmFormat& format) {
+    const int frames = format.sampleRate * AUDIO_SECONDS;
+    QByteArray audio(qsizetype(frames) * format.bytesPerFrame(), Qt::Uninitialized);
+    QRandomGenerator random(7);
+
+    char* out = audio.data();
+    for (int i = 0; i < frames; ++i) {
+        const double tone = 0.4 * std::sin(2.0 * M_PI * 220.0 * i / format.sampleRate);
+        for (int channel = 0; channel < format.channels; ++channel) {
+            const double value = tone + 0.05 * (random.generateDouble() - 0.5);
+            switch (format.sample) {
+            case PcmFormat::Sample::UInt8:
+                *out = char(128 + int(value * 127));
+                break;
+            case PcmFormat::Sample::Int16: {
+                const std::int16_t sample = std::int16_t(value * 32767);
+                std::memcpy(out, &sample, sizeof(sample));
+                break;
+            }
+            case PcmFormat::Sample::Int32: {
+                const std::int32_t sample = std::int32_t(value * 2147483647.0);
+                std::memcpy(out, &sample, sizeof(sample));
+                break;
+            }
+            case PcmFormat::Sample::Float: {
+                const float sample = float(value);
+                std::memcpy(out, &sample, sizeof(sample));
+                break;
+            }
+            }
+            out += format.bytesPerSample();
+        }
+    }
+    return audio;
+}
+
+QString describe(const PcmFormat& format) {
+    static const char* const names[] = {"u8", "s16", "s32", "f32"};
+    return QString("%1k_%2ch_%3")
+        .arg(format.sampleRate / 1000.0)
+        .arg(format.channels)
+        .arg(names[int(format.sample)]);
+}
+
+void benchFormat(const PcmFormat& format) {
+    const QByteArray audio = makeAudio(format);
+    const qsizetype chunkBytes = qsizetype(format.sampleRate) * CHUNK_MS / 1000 * format.bytesPerFrame();
+
+    const QList<QPair<QString, bool>> paths = {
+        {"scalar", false},
+        {"simd", true},
+    };
+
+    for (const auto& [path, simd] : paths) {
+        if (simd && !AudioConverter::simdAvailable()) {
+            continue;
+        }
+
+        AudioConverter converter(format);
+        converter.setSimdEnabled(simd);
+        std::vector<std::int16_t> out;
+        out.reserve(converter.maxOutputSamples(chunkBytes));
+        qint64 outputBytes = 0;
+
+        const bench::Stats stats = bench::measure(ITERATIONS, [&]() {
+            converter.reset();
+            outputBytes = 0;
+            for (qsizetype offset = 0; offset < audio.size(); offset += chunkBytes) {
+                const qsizetype bytes = std::min(chunkBytes, audio.size() - offset);
+                converter.convert(audio.constData() + offset, std::size_t(bytes), out);
+                outputBytes += qint64(out.size() * sizeof(std::int16_t));
+            }
+        });
+
+        bench::report("audio_convert", describe(format) + "/" + path, stats, {
+            {"audio_seconds", AUDIO_SECONDS},
+            {"realtime_factor", AUDIO_SECONDS * 1e6 / stats.p50Us},
+            {"input_bytes", audio.size()},
+            {"output_bytes", outputBytes},
+            {"size_ratio", double(outputBytes) / audio.size()},
+            {"passthrough", converter.isPassthrough()}
+        });
+    }
+}
+
+} // namespace
+
+void runAudioConvertBench() {
+    // Formats commonly returned by QAudioDevice::preferredFormat(), plus the
+    // streamed format itself as the passthrough baseline.
+    const QList<PcmFormat> formats = {
+        {PcmFormat::Sample::Float, 2, 48000},
+        {PcmFormat::Sample::Float, 1, 48000},
+        {PcmFormat::Sample::Int16, 2, 48000},
+        {PcmFormat::Sample::Int16, 2, 44100},
+        {PcmFormat::Sample::Int32, 2, 48000},
+        {PcmFormat::Sample::Int16, 1, 16000},
+    };
+
+    for (const PcmFormat& format : formats) {
+        benchFormat(format);
+    }
+}
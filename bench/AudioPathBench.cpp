@@ -0,0 +1,145 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include "AudioCodec.h"
+#include "AudioStreamer.h"
+#include "VoiceActivityDetector.h"
+#include <boost/asio.hpp>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+constexpr int ITERATIONS = 200;
+constexpr int CHUNK_MS = 100; // QAudioSource buffer size used by AudioStreamer
+
+// A voice-band tone in whatever format the capture device delivers
+QByteArray makeChunk(const QAudioFormat& format) {
+    const int frames = format.framesForDuration(CHUNK_MS * 1000);
+    QByteArray chunk(qsizetype(format.bytesForFrames(frames)), Qt::Uninitialized);
+
+    char* out = chunk.data();
+    for (int i = 0; i < frames; ++i) {
+        const double value = 0.4 * std::sin(2.0 * M_PI * 220.0 * i / format.sampleRate());
+        for (int channel = 0; channel < format.channelCount(); ++channel) {
+            switch (format.sampleFormat()) {
+            case QAudioFormat::UInt8:
+                *out = char(128 + int(value * 127));
+                break;
+            case QAudioFormat::Int16: {
+                const std::int16_t sample = std::int16_t(value * 32767);
+                std::memcpy(out, &sample, sizeof(sample));
+                break;
+            }
+            case QAudioFormat::Int32: {
+                const std::int32_t sample = std::int32_t(value * 2147483647.0);
+                std::memcpy(out, &sample, sizeof(sample));
+                break;
+            }
+            case QAudioFormat::Float: {
+                const float sample = float(value);
+                std::memcpy(out, &sample, sizeof(sample));
+                break;
+            }
+            default:
+                break;
+            }
+            out += format.bytesPerSample();
+        }
+    }
+    return chunk;
+}
+
+struct PathConfig {
+    const char* name;
+    AudioCodec codec;
+    bool vad;
+};
+
+// The capture side writes into AudioStreamer the way QAudioSource does;
+// the io thread drains the ring exactly as HyniWindow::receiveAudioData()
+// and encodes what the detector lets through as TranscriptionClient would.
+void benchPath(const PathConfig& config) {
+    AudioStreamer streamer;
+    const QAudioFormat format = streamer.deviceFormat();
+    if (!format.isValid()) {
+        bench::report("audio_path", QString::fromLatin1(config.name), bench::Stats(), {
+            {"skipped", "no audio input device"}
+        });
+        return;
+    }
+
+    boost::asio::io_context io;
+    auto work = boost::asio::make_work_guard(io);
+    std::thread ioThread([&io]() { io.run(); });
+
+    VoiceActivityDetector vad(VadConfig(), streamer.sampleRate());
+    vad.setEnabled(config.vad);
+    AudioEncoder encoder(config.codec);
+    std::vector<std::uint8_t> message;
+    std::atomic<quint64> framesConsumed{0};
+    quint64 messagesSent = 0;
+
+    streamer.setFramesReadyHandler([&]() {
+        boost::asio::post(io, [&]() {
+            streamer.consumeFrames([&](const AudioFrame& frame) {
+                const auto* bytes = reinterpret_cast<const std::uint8_t*>(frame.data.data());
+                vad.process(bytes, std::size_t(frame.size), [&](const std::uint8_t* data, std::size_t size) {
+                    encoder.encode(reinterpret_cast<const std::int16_t*>(data), size / sizeof(std::int16_t), message);
+                    ++messagesSent;
+                });
+                framesConsumed.fetch_add(1, std::memory_order_release);
+            });
+        });
+    });
+
+    // What startRecording() does before handing the device to QAudioSource
+    streamer.open(QIODevice::WriteOnly);
+    const QByteArray chunk = makeChunk(format);
+
+    const bench::Stats stats = bench::measure(ITERATIONS, [&]() {
+        streamer.write(chunk);
+        const quint64 captured = streamer.stats().framesCaptured;
+        while (framesConsumed.load(std::memory_order_acquire) < captured) {
+            std::this_thread::yield();
+        }
+    });
+
+    streamer.close();
+    work.reset();
+    ioThread.join();
+
+    const AudioStreamer::Stats capture = streamer.stats();
+    if (capture.framesCaptured == 0) {
+        bench::report("audio_path", QString::fromLatin1(config.name), bench::Stats(), {
+            {"skipped", "capture format not supported"}
+        });
+        return;
+    }
+
+    const QString name = QString("%1/%2Hz_%3ch")
+                             .arg(QString::fromLatin1(config.name))
+                             .arg(format.sampleRate())
+                             .arg(format.channelCount());
+    bench::report("audio_path", name, stats, {
+        {"chunk_ms", CHUNK_MS},
+        {"realtime_factor", stats.meanUs > 0 ? CHUNK_MS * 1000.0 / stats.meanUs : 0.0},
+        {"frames_captured", qint64(capture.framesCaptured)},
+        {"frames_dropped", qint64(capture.framesDropped)},
+        {"messages_encoded", qint64(messagesSent)}
+    });
+}
+
+} // namespace
+
+void runAudioPathBench() {
+    const PathConfig configs[] = {
+        {"pcm16", AudioCodec::Pcm16, false},
+        {"pcm16_vad", AudioCodec::Pcm16, true},
+        {"ima_adpcm_vad", AudioCodec::ImaAdpcm, true},
+    };
+    for (const PathConfig& config : configs) {
+        benchPath(config);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// Minimal timing helpers for qhyni_bench. Every measurement is written to
+// stdout as one JSON object per line, so runs of different builds can be
+// diffed or loaded into a spreadsheet.
+namespace bench {
+
+struct Stats {
+    int iterations{0};
+    double minUs{0};
+    double meanUs{0};
+    double p50Us{0};
+    double p99Us{0};
+};
+
+template <typename Fn>
+Stats measure(int iterations, Fn&& fn) {
+    fn(); // warm-up, not recorded
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        fn();
+        samples.push_back(timer.nsecsElapsed() / 1000.0);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    Stats stats;
+    stats.iterations = iterations;
+    stats.minUs = samples.front();
+    double total = 0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    stats.meanUs = total / samples.size();
+    stats.p50Us = samples[samples.size() / 2];
+    stats.p99Us = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    return stats;
+}
+
+inline void report(const QString& suite,
+                   const QString& name,
+                   const Stats& stats,
+                   const QJsonObject& extra = QJsonObject()) {
+    QJsonObject result{
+        {"suite", suite},
+        {"name", name},
+        {"iterations", stats.iterations},
+        {"min_us", stats.minUs},
+        {"mean_us", stats.meanUs},
+        {"p50_us", stats.p50Us},
+        {"p99_us", stats.p99Us}
+    };
+    for (auto it = extra.begin(); it != extra.end(); ++it) {
+        result.insert(it.key(), it.value());
+    }
+
+    std::fputs(QJsonDocument(result).toJson(QJsonDocument::Compact).constData(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+} // namespace bench
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,15 @@
+#ifndef BENCH_SUITES_H
+#define BENCH_SUITES_H
+
+void runImageEncodeBench();
+void runAudioConvertBench();
+void runAudioCodecBench();
+void runTranscriptMergeBench();
+void runTranscriptWidgetBench();
+void runHistoryRenderBench();
+void runTranscriptionJsonBench();
+#ifdef ENABLE_AUDIO_STREAM
+void runAudioPathBench();
+#endif
+
+#endif // BENCH_SUITES_H
@@ -0,0 +1,105 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include <QStringList>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextEdit>
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+
+// Answers already in the History tab when the next one arrives
+const int HISTORY_SIZES[] = {10, 50, 200};
+
+// A typical coding answer: prose, a list and a code block
+QString makeAnswer(int index) {
+    return QString("### Answer %1\n\n"
+                   "The idea is to keep the lowest price seen so far and, for every day, "
+                   "compare selling today against the best profit found.\n\n"
+                   "- Time: O(n)\n"
+                   "- Space: O(1)\n\n"
+                   "```cpp\n"
+                   "int maxProfit(const std::vector<int>& prices) {\n"
+                   "    int best = 0, low = INT_MAX;\n"
+                   "    for (int price : prices) {\n"
+                   "        low = std::min(low, price);\n"
+                   "        best = std::max(best, price - low);\n"
+                   "    }\n"
+                   "    return best;\n"
+                   "}\n"
+                   "```\n\n"
+                   "Edge cases: an empty array and strictly falling prices both return **0**.\n")
+        .arg(index);
+}
+
+// What handleAPIResponse did before: re-render the whole session
+void renderAll(QTextEdit& editor, const QStringList& history) {
+    QString markdown;
+    for (const QString& page : history) {
+        markdown += page;
+        markdown += "\n\n---\n\n";
+    }
+    editor.setMarkdown(markdown);
+}
+
+// HyniWindow::appendToHistory: parse and lay out only the new entry
+void appendOne(QTextEdit& editor, const QString& response) {
+    QTextDocument* document = editor.document();
+    QTextCursor cursor(document);
+    cursor.movePosition(QTextCursor::End);
+
+    if (!document->isEmpty()) {
+        cursor.insertBlock();
+        cursor.insertMarkdown("---");
+        cursor.insertBlock();
+    }
+    cursor.insertMarkdown(response);
+}
+
+} // namespace
+
+void runHistoryRenderBench() {
+    QTextEdit answerEditor;
+    answerEditor.resize(900, 700);
+    const QString answer = makeAnswer(0);
+
+    // The answer tab itself, rendered once per response
+    const bench::Stats answerStats = bench::measure(ITERATIONS * 4, [&]() {
+        answerEditor.setMarkdown(answer);
+    });
+    bench::report("history_render", "answer_setMarkdown", answerStats, {
+        {"markdown_chars", answer.size()}
+    });
+
+    for (int size : HISTORY_SIZES) {
+        QStringList history;
+        for (int i = 0; i < size; ++i) {
+            history.append(makeAnswer(i));
+        }
+        const QString session = QString::number(size) + " answers";
+
+        QTextEdit fullEditor;
+        fullEditor.resize(900, 700);
+        const bench::Stats fullStats = bench::measure(ITERATIONS, [&]() {
+            renderAll(fullEditor, history);
+        });
+        bench::report("history_render", "rerender_all/" + session, fullStats, {
+            {"blocks", fullEditor.document()->blockCount()}
+        });
+
+        // Every iteration adds one more answer to an already full history
+        QTextEdit appendEditor;
+        appendEditor.resize(900, 700);
+        for (const QString& page : history) {
+            appendOne(appendEditor, page);
+        }
+        const bench::Stats appendStats = bench::measure(ITERATIONS, [&]() {
+            appendOne(appendEditor, answer);
+        });
+        bench::report("history_render", "append/" + session, appendStats, {
+            {"blocks", appendEditor.document()->blockCount()},
+            {"speedup", fullStats.meanUs / appendStats.meanUs}
+        });
+    }
+}
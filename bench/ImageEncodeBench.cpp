@@ -0,0 +1,126 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include "ImageEncoder.h"
+#include <QBuffer>
+#include <QFont>
+#include <QPainter>
+#include <QPixmap>
+#include <QRandomGenerator>
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+
+// IDE-like frame: flat background, a side panel and lines of code.
+QImage makeScreenshot(const QSize& size) {
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(250, 250, 250));
+
+    QPainter painter(&image);
+    painter.fillRect(0, 0, size.width() / 6, size.height(), QColor(37, 37, 38));
+    painter.fillRect(0, 0, size.width(), 32, QColor(60, 60, 60));
+
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPixelSize(std::max(12, size.height() / 70));
+    painter.setFont(font);
+
+    const QStringList lines = {
+        "int maxProfit(const std::vector<int>& prices) {",
+        "    int best = 0, low = INT_MAX;",
+        "    for (int price : prices) {",
+        "        low = std::min(low, price);",
+        "        best = std::max(best, price - low);",
+        "    }",
+        "    return best;",
+        "}",
+        "// Given an array prices where prices[i] is the price on day i,",
+        "// return the maximum profit from a single buy and sell.",
+    };
+
+    const int lineHeight = font.pixelSize() + 6;
+    int row = 0;
+    for (int y = 48; y < size.height(); y += lineHeight, ++row) {
+        painter.setPen(row % 3 == 0 ? QColor(0, 0, 160) : QColor(30, 30, 30));
+        painter.drawText(size.width() / 6 + 16, y, lines[row % lines.size()]);
+    }
+    return image;
+}
+
+// Noise over a gradient, the worst case for PNG.
+QImage makePhoto(const QSize& size) {
+    QImage image(size, QImage::Format_RGB32);
+    QRandomGenerator random(42);
+
+    for (int y = 0; y < size.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            const int noise = random.bounded(24);
+            line[x] = qRgb((x * 255 / size.width() + noise) & 0xff,
+                           (y * 255 / size.height() + noise) & 0xff,
+                           (128 + noise) & 0xff);
+        }
+    }
+    return image;
+}
+
+// The upload path before ImageEncoder: full resolution PNG from a QPixmap.
+QByteArray encodeLegacy(const QImage& image) {
+    const QPixmap pixmap = QPixmap::fromImage(image);
+
+    QByteArray byteArray;
+    QBuffer buffer(&byteArray);
+    buffer.open(QIODevice::WriteOnly);
+    pixmap.save(&buffer, "PNG", 80);
+    return byteArray.toBase64();
+}
+
+void benchImage(const QString& content, const QImage& image) {
+    const QString resolution = QString("%1x%2").arg(image.width()).arg(image.height());
+
+    QByteArray legacy;
+    const bench::Stats legacyStats = bench::measure(ITERATIONS, [&]() {
+        legacy = encodeLegacy(image);
+    });
+    bench::report("image_encode", content + "/" + resolution + "/legacy_png", legacyStats, {
+        {"base64_bytes", legacy.size()},
+        {"mime", "image/png"}
+    });
+
+    const QList<QPair<QString, hyni::chat_api::QUESTION_TYPE>> profiles = {
+        {"coding", hyni::chat_api::QUESTION_TYPE::Coding},
+        {"system_design", hyni::chat_api::QUESTION_TYPE::SystemDesign},
+        {"general", hyni::chat_api::QUESTION_TYPE::General},
+    };
+
+    for (const auto& [name, type] : profiles) {
+        const ImageEncodeProfile profile = ImageEncodeProfile::forQuestionType(type);
+
+        EncodedImage encoded;
+        const bench::Stats stats = bench::measure(ITERATIONS, [&]() {
+            encoded = ImageEncoder::encode(image, profile);
+        });
+        bench::report("image_encode", content + "/" + resolution + "/" + name, stats, {
+            {"base64_bytes", encoded.base64.size()},
+            {"mime", QString::fromLatin1(encoded.mimeType)},
+            {"output_width", encoded.size.width()},
+            {"output_height", encoded.size.height()},
+            {"size_ratio_vs_legacy", double(encoded.base64.size()) / legacy.size()}
+        });
+    }
+}
+
+} // namespace
+
+void runImageEncodeBench() {
+    const QList<QSize> resolutions = {
+        {1920, 1080},
+        {2560, 1440},
+        {3840, 2160},
+    };
+
+    for (const QSize& resolution : resolutions) {
+        benchImage("screenshot", makeScreenshot(resolution));
+        benchImage("photo", makePhoto(resolution));
+    }
+}
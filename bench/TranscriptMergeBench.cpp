@@ -0,0 +1,148 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include "HighlightTableWidget.h"
+#include "TranscriptBuffer.h"
+#include "response_utils.h"
+#include <QRandomGenerator>
+#include <QStringList>
+#include <iterator>
+
+namespace {
+
+constexpr int ITERATIONS = 10;
+
+// From a short question to a long answer at the server's pace
+const int SESSION_FRAGMENTS[] = {100, 500, 2000};
+
+const char* const WORDS[] = {
+    "so", "the", "question", "is", "how", "would", "you", "design", "a", "rate",
+    "limiter", "for", "an", "API", "gateway", "that", "handles", "millions", "of",
+    "requests", "per", "second", "and", "what", "happens", "when", "one", "node",
+    "goes", "down", "we", "need", "to", "keep", "latency", "low", "while", "staying",
+    "consistent", "across", "regions", "tell", "me", "about", "time", "disagreed",
+    "with", "your", "manager", "it's", "fine", "I", "think", "maybe", "cache", "layer"
+};
+
+struct Stream {
+    QStringList fragments;
+    QString expected;
+};
+
+// The server re-sends the last few words of its window with one to four new
+// words at the end, the pattern seen from faster-whisper style streaming.
+Stream makeStream(int fragmentCount) {
+    QRandomGenerator random(7);
+    QStringList spoken;
+    Stream stream;
+
+    for (int i = 0; i < fragmentCount; ++i) {
+        const int newWords = 1 + int(random.bounded(4));
+        for (int w = 0; w < newWords; ++w) {
+            spoken.append(QString::fromLatin1(WORDS[random.bounded(int(std::size(WORDS)))]));
+        }
+        const int repeated = i == 0 ? 0 : 4 + int(random.bounded(12));
+        const int windowWords = std::min<int>(spoken.size(), newWords + repeated);
+        stream.fragments.append(spoken.mid(spoken.size() - windowWords).join(' '));
+    }
+    stream.expected = spoken.join(' ');
+    return stream;
+}
+
+} // namespace
+
+void runTranscriptMergeBench() {
+    for (int fragments : SESSION_FRAGMENTS) {
+        const Stream stream = makeStream(fragments);
+        const QString session = QString::number(fragments) + " fragments";
+
+        // What HighlightTableWidget::addText did before: convert the whole
+        // row both ways and merge it with every fragment
+        QString merged;
+        const bench::Stats baselineStats = bench::measure(ITERATIONS, [&]() {
+            merged = stream.fragments.first();
+            for (qsizetype i = 1; i < stream.fragments.size(); ++i) {
+                int matchIndex = 0;
+                merged = QString::fromStdString(hyni::response_utils::merge_strings(
+                    merged.toStdString(), stream.fragments[i].toStdString(), matchIndex));
+            }
+        });
+        bench::report("transcript_merge", "merge_strings/" + session, baselineStats, {
+            {"us_per_fragment", baselineStats.meanUs / fragments},
+            {"output_chars", merged.size()},
+            {"exact", merged == stream.expected}
+        });
+
+        for (bool simd : {false, true}) {
+            if (simd && !TranscriptBuffer::simdAvailable()) {
+                continue;
+            }
+
+            TranscriptBuffer buffer;
+            buffer.setSimdEnabled(simd);
+            const bench::Stats stats = bench::measure(ITERATIONS, [&]() {
+                buffer.clear();
+                for (const QString& fragment : stream.fragments) {
+                    buffer.append(fragment);
+                }
+            });
+
+            const QString name = QString(simd ? "buffer_sse2/" : "buffer_scalar/") + session;
+            bench::report("transcript_merge", name, stats, {
+                {"us_per_fragment", stats.meanUs / fragments},
+                {"speedup", baselineStats.meanUs / stats.meanUs},
+                {"output_chars", buffer.text().size()},
+                {"exact", buffer.text() == stream.expected}
+            });
+        }
+    }
+}
+
+// The same streams through the transcript table, including the row index
+// and layout: once per fragment as addText() does, and batched per display
+// frame as queueText() does.
+void runTranscriptWidgetBench() {
+    HighlightTableWidget table;
+    table.resize(900, 600);
+
+    for (int fragments : SESSION_FRAGMENTS) {
+        const Stream stream = makeStream(fragments);
+        const QString session = QString::number(fragments) + " fragments";
+
+        const bench::Stats addStats = bench::measure(ITERATIONS, [&]() {
+            table.clearRow();
+            for (const QString& fragment : stream.fragments) {
+                table.addText(fragment);
+            }
+        });
+        bench::report("transcript_widget", "addText/" + session, addStats, {
+            {"us_per_fragment", addStats.meanUs / fragments},
+            {"exact", table.getLastRowString() == stream.expected}
+        });
+
+        // A fast talker at 60 Hz: about four fragments per frame
+        const bench::Stats queueStats = bench::measure(ITERATIONS, [&]() {
+            table.clearRow();
+            for (qsizetype i = 0; i < stream.fragments.size(); ++i) {
+                table.queueText(stream.fragments[i]);
+                if (i % 4 == 3) {
+                    table.applyPendingText();
+                }
+            }
+            table.applyPendingText();
+        });
+        bench::report("transcript_widget", "queueText/" + session, queueStats, {
+            {"us_per_fragment", queueStats.meanUs / fragments},
+            {"speedup", addStats.meanUs / queueStats.meanUs},
+            {"exact", table.getLastRowString() == stream.expected}
+        });
+
+        const QString needle = stream.fragments[stream.fragments.size() / 2];
+        QList<int> rows;
+        const bench::Stats findStats = bench::measure(ITERATIONS * 10, [&]() {
+            rows = table.findRows(needle);
+        });
+        bench::report("transcript_widget", "findRows/" + session, findStats, {
+            {"matches", rows.size()}
+        });
+    }
+}
@@ -0,0 +1,95 @@
+#include "BenchHarness.h"
+#include "BenchSuites.h"
+#include <QJsonParseError>
+#include <QJsonValue>
+#include <QList>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+constexpr int MESSAGES = 10000;
+
+// Transcripts as the server sends them, from a few words to a long window
+QList<QByteArray> makeMessages(int wordsPerMessage) {
+    QList<QByteArray> messages;
+    messages.reserve(MESSAGES);
+    for (int i = 0; i < MESSAGES; ++i) {
+        QString content;
+        for (int w = 0; w < wordsPerMessage; ++w) {
+            content += (w ? " word" : "word") + QString::number((i + w) % 97);
+        }
+        const QJsonObject message{{"type", "transcribe"}, {"content", content}};
+        messages.append(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    }
+    return messages;
+}
+
+// The original onMessageReceived: std::string in, nlohmann::json, std::string
+// fields converted to QString for the table
+qsizetype parseLegacy(const QList<QByteArray>& messages) {
+    qsizetype chars = 0;
+    for (const QByteArray& bytes : messages) {
+        const std::string message = bytes.toStdString();
+        try {
+            auto json = nlohmann::json::parse(message);
+            if (json.contains("type")) {
+                const std::string type = json["type"];
+                if (type == "transcribe") {
+                    const std::string content = json["content"];
+                    chars += QString::fromStdString(content).size();
+                }
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return chars;
+}
+
+// TranscriptionClient::handleTextMessage: parsed in place from the read
+// buffer with QJsonDocument
+qsizetype parseInPlace(const QList<QByteArray>& messages) {
+    qsizetype chars = 0;
+    for (const QByteArray& bytes : messages) {
+        const QByteArray view = QByteArray::fromRawData(bytes.constData(), bytes.size());
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(view, &error);
+        if (error.error != QJsonParseError::NoError || !document.isObject()) {
+            continue;
+        }
+        const QJsonObject object = document.object();
+        if (object.value("type").toString() == "transcribe") {
+            chars += object.value("content").toString().size();
+        }
+    }
+    return chars;
+}
+
+} // namespace
+
+void runTranscriptionJsonBench() {
+    for (int words : {4, 32}) {
+        const QList<QByteArray> messages = makeMessages(words);
+        const QString batch = QString("%1 messages/%2 words").arg(MESSAGES).arg(words);
+
+        qsizetype legacyChars = 0;
+        const bench::Stats legacyStats = bench::measure(ITERATIONS, [&]() {
+            legacyChars = parseLegacy(messages);
+        });
+        bench::report("transcription_json", "nlohmann/" + batch, legacyStats, {
+            {"us_per_message", legacyStats.meanUs / MESSAGES},
+            {"content_chars", legacyChars}
+        });
+
+        qsizetype chars = 0;
+        const bench::Stats stats = bench::measure(ITERATIONS, [&]() {
+            chars = parseInPlace(messages);
+        });
+        bench::report("transcription_json", "qjson_in_place/" + batch, stats, {
+            {"us_per_message", stats.meanUs / MESSAGES},
+            {"speedup", legacyStats.meanUs / stats.meanUs},
+            {"content_chars", chars}
+        });
+    }
+}
@@ -0,0 +1,78 @@
+#include <QApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <cstdio>
+#include "BenchSuites.h"
+
+namespace {
+
+struct Suite {
+    const char* name;
+    void (*run)();
+};
+
+const Suite SUITES[] = {
+    {"image_encode", runImageEncodeBench},
+    {"audio_convert", runAudioConvertBench},
+    {"audio_codec", runAudioCodecBench},
+    {"transcript_merge", runTranscriptMergeBench},
+    {"transcript_widget", runTranscriptWidgetBench},
+    {"history_render", runHistoryRenderBench},
+    {"transcription_json", runTranscriptionJsonBench},
+#ifdef ENABLE_AUDIO_STREAM
+    {"audio_path", runAudioPathBench},
+#endif
+};
+
+// First line of every run, so results from different builds can be told apart
+void reportBuild() {
+    const QJsonObject build{
+        {"suite", "build"},
+        {"commit", QHYNI_COMMIT_HASH},
+        {"qt", qVersion()},
+#if defined(__clang__)
+        {"compiler", "clang " __clang_version__},
+#elif defined(__GNUC__)
+        {"compiler", "gcc " __VERSION__},
+#else
+        {"compiler", "unknown"},
+#endif
+#ifdef NDEBUG
+        {"assertions", false},
+#else
+        {"assertions", true},
+#endif
+    };
+    std::fputs(QJsonDocument(build).toJson(QJsonDocument::Compact).constData(), stdout);
+    std::fputc('\n', stdout);
+}
+
+} // namespace
+
+// Usage: qhyni_bench [--list] [suite...]
+// Runs all suites when none are given. Results are JSON lines on stdout.
+int main(int argc, char *argv[]) {
+    // Text rendering and the widget suites need an application, but never
+    // a display.
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QStringList selected = app.arguments().mid(1);
+    if (selected.removeAll("--list") > 0) {
+        for (const Suite& suite : SUITES) {
+            std::puts(suite.name);
+        }
+        return 0;
+    }
+
+    reportBuild();
+
+    for (const Suite& suite : SUITES) {
+        if (selected.isEmpty() || selected.contains(QString::fromLatin1(suite.name))) {
+            suite.run();
+        }
+    }
+    return 0;
+}
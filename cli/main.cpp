@@ -0,0 +1,302 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "HyniCore.h"
+#include "Metrics.h"
+#include "MetricsExporter.h"
+#include "ProviderConfig.h"
+
+namespace {
+
+// How often a metrics file given with --metrics-file is rewritten
+constexpr int METRICS_EXPORT_INTERVAL_MS = 15000;
+
+int s_signalFds[2] = {-1, -1};
+
+void handleSignal(int) {
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = ::write(s_signalFds[0], &byte, 1);
+}
+
+// One JSON object per line on stdout, flushed so pipes see it right away
+void emitEvent(QJsonObject event) {
+    std::fputs(QJsonDocument(event).toJson(QJsonDocument::Compact).constData(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+bool parseQuestionType(const QString& name, hyni::chat_api::QUESTION_TYPE& type) {
+    if (name == "general") {
+        type = hyni::chat_api::QUESTION_TYPE::General;
+    } else if (name == "behavioral") {
+        type = hyni::chat_api::QUESTION_TYPE::Behavioral;
+    } else if (name == "system-design") {
+        type = hyni::chat_api::QUESTION_TYPE::SystemDesign;
+    } else if (name == "coding") {
+        type = hyni::chat_api::QUESTION_TYPE::Coding;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Questions come from stdin, one per line, and optionally from every
+// transcript; answers and timings go to stdout.
+class CliDaemon
+{
+public:
+    CliDaemon(HyniCore* core, bool printAnswers, bool exitWhenIdle)
+        : m_core(core),
+        m_printAnswers(printAnswers),
+        m_exitWhenIdle(exitWhenIdle)
+    {
+        // Connected through m_context, so nothing reaches a destroyed daemon
+        QObject::connect(core, &HyniCore::transcriptionConnected, &m_context, [](bool connected) {
+            emitEvent({{"event", connected ? "connected" : "disconnected"}});
+        });
+        QObject::connect(core, &HyniCore::transcriptionError, &m_context, [](const QString& error) {
+            emitEvent({{"event", "transport_error"}, {"error", error}});
+        });
+        QObject::connect(core, &HyniCore::partialResponseReceived, &m_context, [this](quint64 requestId, const QString&) {
+            auto it = m_requests.find(requestId);
+            if (it != m_requests.end() && !it->streamed) {
+                it->streamed = true;
+                emitEvent({{"event", "first_token"}, {"id", qint64(requestId)},
+                           {"ms", it->submitted.nsecsElapsed() / 1e6}});
+            }
+        });
+        QObject::connect(core, &HyniCore::responseReceived, &m_context,
+                         [this](quint64 requestId, const QString& response, bool fromCache) {
+            const Request request = m_requests.value(requestId);
+            QJsonObject event{{"event", "answer"}, {"id", qint64(requestId)},
+                              {"language", request.language}, {"cached", fromCache},
+                              {"chars", response.size()},
+                              {"ms", request.submitted.isValid() ? request.submitted.nsecsElapsed() / 1e6 : 0.0}};
+            if (m_printAnswers) {
+                event.insert("text", response);
+            }
+            emitEvent(event);
+        });
+        QObject::connect(core, &HyniCore::errorOccurred, &m_context, [](quint64 requestId, const QString& error) {
+            emitEvent({{"event", "error"}, {"id", qint64(requestId)}, {"error", error}});
+        });
+        QObject::connect(core, &HyniCore::requestFinished, &m_context, [this](quint64 requestId) {
+            m_requests.remove(requestId);
+            quitIfIdle();
+        });
+        QObject::connect(core, &HyniCore::imageSubmitted, &m_context, [this](const QVector<HyniCore::Submission>& submissions) {
+            track("image", submissions);
+        });
+        QObject::connect(core, &HyniCore::needApiKey, &m_context, [core]() {
+            emitEvent({{"event", "error"},
+                       {"error", QString("No API key, set %1").arg(providerEndpoint(core->provider()).apiKeyEnv)}});
+        });
+        QObject::connect(core, &HyniCore::warning, &m_context, [](const QString& message) {
+            emitEvent({{"event", "warning"}, {"message", message}});
+        });
+    }
+
+    void askTranscripts() {
+        QObject::connect(m_core, &HyniCore::transcriptReceived, &m_context, [this](const QString& text) {
+            emitEvent({{"event", "transcript"}, {"text", text}});
+            track("transcript", m_core->askText(text));
+        });
+    }
+
+    void readStdin() {
+        m_stdin = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, &m_context);
+        QObject::connect(m_stdin, &QSocketNotifier::activated, &m_context, [this]() {
+            char buffer[4096];
+            const ssize_t size = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (size <= 0) {
+                m_stdin->setEnabled(false);
+                m_inputClosed = true;
+                askLines(true);
+                quitIfIdle();
+                return;
+            }
+            m_pending.append(buffer, size);
+            askLines(false);
+        });
+    }
+
+private:
+    struct Request {
+        QString language;
+        QElapsedTimer submitted;
+        bool streamed{false};
+    };
+
+    void askLines(bool flush) {
+        qsizetype newline;
+        while ((newline = m_pending.indexOf('\n')) >= 0 || (flush && !m_pending.isEmpty())) {
+            const qsizetype end = newline >= 0 ? newline : m_pending.size();
+            const QString question = QString::fromUtf8(m_pending.left(end)).trimmed();
+            m_pending.remove(0, std::min(end + 1, m_pending.size()));
+            if (!question.isEmpty()) {
+                track("stdin", m_core->askText(question));
+            }
+        }
+    }
+
+    void track(const char* source, const QVector<HyniCore::Submission>& submissions) {
+        for (const HyniCore::Submission& submission : submissions) {
+            if (submission.requestId == 0) {
+                emitEvent({{"event", "dropped"}, {"source", source}, {"language", submission.language}});
+                continue;
+            }
+            Request request;
+            request.language = submission.language;
+            request.submitted.start();
+            m_requests.insert(submission.requestId, request);
+            emitEvent({{"event", "submitted"}, {"id", qint64(submission.requestId)},
+                       {"source", source}, {"language", submission.language}});
+        }
+    }
+
+    void quitIfIdle() {
+        if (m_exitWhenIdle && m_inputClosed && m_requests.isEmpty()) {
+            QCoreApplication::quit();
+        }
+    }
+
+    QObject m_context;
+    HyniCore* m_core;
+    bool m_printAnswers;
+    bool m_exitWhenIdle;
+    QSocketNotifier* m_stdin{nullptr};
+    QByteArray m_pending;
+    bool m_inputClosed{false};
+    QHash<quint64, Request> m_requests;
+};
+
+} // namespace
+
+// Runs the question -> answer pipelines of Qhyni without a display. Events
+// are JSON lines on stdout, logging goes to stderr.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qhyni_cli");
+    QCoreApplication::setApplicationVersion(QHYNI_COMMIT_HASH);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless Qhyni: questions from stdin, answers as JSON lines on stdout");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOptions({
+        {"host", "Transcription server host.", "host", "localhost"},
+        {"port", "Transcription server port.", "port", HyniCore::defaultTranscriptionPort()},
+        {"no-transcription", "Do not connect to a transcription server."},
+#ifdef ENABLE_AUDIO_STREAM
+        {"audio", "Capture audio and stream it to the transcription server."},
+#endif
+        {"ask-transcripts", "Ask every transcript as a question."},
+        {"watch", "Ask about screenshots written to this folder.", "folder"},
+        {"provider", "openai or deepseek.", "provider", "openai"},
+        {"type", "general, behavioral, system-design or coding.", "type", "coding"},
+        {"language", "Programming language; repeat to ask coding questions in several.", "language"},
+        {"workers", "Concurrent API requests.", "count", "3"},
+        {"queue", "Requests that may wait for a free worker.", "count", "8"},
+        {"stream", "Stream answers; skips hyni's system prompts and model selection."},
+        {"no-cache", "Do not answer repeated questions from the response cache."},
+        {"hedge", "Also ask the other provider when an answer is slow; needs its API key."},
+        {"print-answers", "Include the answer text in answer events."},
+        {"exit-when-idle", "Quit once stdin is closed and every answer arrived."},
+        {"metrics-port", "Serve Prometheus metrics on this localhost port.", "port"},
+        {"metrics-file", "Keep Prometheus metrics in this file.", "path"},
+    });
+    parser.process(app);
+
+    hyni::chat_api::QUESTION_TYPE questionType;
+    if (!parseQuestionType(parser.value("type"), questionType)) {
+        qCritical() << "Unknown question type" << parser.value("type");
+        return 2;
+    }
+    const QString providerName = parser.value("provider");
+    if (providerName != "openai" && providerName != "deepseek") {
+        qCritical() << "Unknown provider" << providerName;
+        return 2;
+    }
+
+    HyniCore::Options options;
+    options.transcriptionHost = parser.value("host");
+    options.transcriptionPort = parser.value("port");
+    options.transcription = !parser.isSet("no-transcription");
+#ifdef ENABLE_AUDIO_STREAM
+    options.captureAudio = parser.isSet("audio");
+#else
+    options.captureAudio = false;
+#endif
+    options.watchFolder = parser.value("watch");
+    options.workerCount = std::max(parser.value("workers").toInt(), 1);
+    options.queueCapacity = std::max(parser.value("queue").toInt(), 0);
+
+    // Stopped through the event loop, so in-flight work shuts down cleanly
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_signalFds) == 0) {
+        auto* notifier = new QSocketNotifier(s_signalFds[1], QSocketNotifier::Read, &app);
+        QObject::connect(notifier, &QSocketNotifier::activated, &app, [notifier]() {
+            char byte;
+            [[maybe_unused]] const ssize_t size = ::read(s_signalFds[1], &byte, 1);
+            notifier->setEnabled(false);
+            QCoreApplication::quit();
+        });
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+    }
+
+    MetricsExporter exporter;
+    if (parser.isSet("metrics-port") || parser.isSet("metrics-file")) {
+        MetricsRegistry::setEnabled(true);
+    }
+    if (parser.isSet("metrics-port")) {
+        const quint16 port = quint16(parser.value("metrics-port").toUInt());
+        if (!exporter.listen(port)) {
+            qCritical() << "Cannot serve metrics:" << exporter.errorString();
+            return 1;
+        }
+    }
+    if (parser.isSet("metrics-file")) {
+        exporter.setExportFile(parser.value("metrics-file"), METRICS_EXPORT_INTERVAL_MS);
+    }
+
+    try {
+        HyniCore core(options);
+        core.setQuestionType(questionType);
+        core.setProvider(providerName == "deepseek" ? hyni::chat_api::API_PROVIDER::DeepSeek
+                                                    : hyni::chat_api::API_PROVIDER::OpenAI);
+        if (parser.isSet("language")) {
+            core.setLanguages(parser.values("language"));
+        }
+        core.setStreamingEnabled(parser.isSet("stream"));
+        core.setCacheEnabled(!parser.isSet("no-cache"));
+        core.setHedgingEnabled(parser.isSet("hedge"));
+
+        CliDaemon daemon(&core, parser.isSet("print-answers"), parser.isSet("exit-when-idle"));
+        if (parser.isSet("ask-transcripts")) {
+            daemon.askTranscripts();
+        }
+        daemon.readStdin();
+
+        core.start();
+        const int result = app.exec();
+
+        core.cancelAll();
+        if (parser.isSet("metrics-file")) {
+            MetricsExporter::writeFile(parser.value("metrics-file"));
+        }
+        return result;
+    } catch (const std::exception& e) {
+        qCritical() << "Fatal error:" << e.what();
+        return -1;
+    }
+}
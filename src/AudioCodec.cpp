@@ -0,0 +1,234 @@
+#include "AudioCodec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int ADPCM_HEADER_BYTES = 4;
+constexpr std::uint8_t ADPCM_FLAG_PADDED = 0x01;
+constexpr int ADPCM_MAX_STEP_INDEX = 88;
+
+constexpr int ADPCM_INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+constexpr int ADPCM_STEP_TABLE[ADPCM_MAX_STEP_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+constexpr int MULAW_BIAS = 0x84;
+constexpr int MULAW_CLIP = 32635;
+
+// Applies one 4-bit code to the predictor, identically for both sides
+void adpcmStep(int code, int& predictor, int& stepIndex) {
+    const int step = ADPCM_STEP_TABLE[stepIndex];
+    int delta = step >> 3;
+    if (code & 4) {
+        delta += step;
+    }
+    if (code & 2) {
+        delta += step >> 1;
+    }
+    if (code & 1) {
+        delta += step >> 2;
+    }
+    predictor = std::clamp(predictor + ((code & 8) ? -delta : delta), -32768, 32767);
+    stepIndex = std::clamp(stepIndex + ADPCM_INDEX_TABLE[code], 0, ADPCM_MAX_STEP_INDEX);
+}
+
+int adpcmEncodeSample(int sample, int& predictor, int& stepIndex) {
+    int diff = sample - predictor;
+    int code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+
+    int step = ADPCM_STEP_TABLE[stepIndex];
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+    }
+
+    adpcmStep(code, predictor, stepIndex);
+    return code;
+}
+
+std::uint8_t mulawEncodeSample(int sample) {
+    const int sign = sample < 0 ? 0x80 : 0;
+    int magnitude = std::min(sign ? -sample : sample, MULAW_CLIP) + MULAW_BIAS;
+
+    int exponent = 7;
+    for (int mask = 0x4000; !(magnitude & mask) && exponent > 0; mask >>= 1) {
+        --exponent;
+    }
+    const int mantissa = (magnitude >> (exponent + 3)) & 0x0f;
+    return std::uint8_t(~(sign | (exponent << 4) | mantissa));
+}
+
+std::int16_t mulawDecodeSample(std::uint8_t code) {
+    code = std::uint8_t(~code);
+    const int exponent = (code >> 4) & 0x07;
+    const int magnitude = ((((code & 0x0f) << 3) + MULAW_BIAS) << exponent) - MULAW_BIAS;
+    return std::int16_t((code & 0x80) ? -magnitude : magnitude);
+}
+
+} // namespace
+
+const char* audioCodecName(AudioCodec codec)
+{
+    switch (codec) {
+    case AudioCodec::Pcm16:
+        return "pcm16";
+    case AudioCodec::MuLaw:
+        return "mulaw";
+    case AudioCodec::ImaAdpcm:
+        return "ima-adpcm";
+    }
+    return "pcm16";
+}
+
+bool audioCodecFromName(const std::string& name, AudioCodec& codec)
+{
+    for (AudioCodec candidate : {AudioCodec::Pcm16, AudioCodec::MuLaw, AudioCodec::ImaAdpcm}) {
+        if (name == audioCodecName(candidate)) {
+            codec = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+AudioEncoder::AudioEncoder(AudioCodec codec)
+    : m_codec(codec)
+{
+}
+
+AudioCodec AudioEncoder::codec() const
+{
+    return m_codec;
+}
+
+void AudioEncoder::setCodec(AudioCodec codec)
+{
+    m_codec = codec;
+    reset();
+}
+
+void AudioEncoder::reset()
+{
+    m_stepIndex = 0;
+}
+
+void AudioEncoder::encode(const std::int16_t* samples, std::size_t count, std::vector<std::uint8_t>& out)
+{
+    out.clear();
+    if (count == 0) {
+        return;
+    }
+
+    switch (m_codec) {
+    case AudioCodec::Pcm16:
+        out.resize(count * sizeof(std::int16_t));
+        std::memcpy(out.data(), samples, out.size());
+        break;
+
+    case AudioCodec::MuLaw:
+        out.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = mulawEncodeSample(samples[i]);
+        }
+        break;
+
+    case AudioCodec::ImaAdpcm: {
+        // The first sample travels verbatim in the header and seeds the
+        // predictor; the step index continues from the previous message so
+        // the quantiser does not have to re-adapt every 100 ms.
+        const std::size_t codes = count - 1;
+        out.assign(ADPCM_HEADER_BYTES + (codes + 1) / 2, 0);
+
+        int predictor = samples[0];
+        int stepIndex = m_stepIndex;
+        out[0] = std::uint8_t(predictor & 0xff);
+        out[1] = std::uint8_t((predictor >> 8) & 0xff);
+        out[2] = std::uint8_t(stepIndex);
+        out[3] = (codes % 2) ? ADPCM_FLAG_PADDED : 0;
+
+        std::uint8_t* packed = out.data() + ADPCM_HEADER_BYTES;
+        for (std::size_t i = 0; i < codes; ++i) {
+            const int code = adpcmEncodeSample(samples[i + 1], predictor, stepIndex);
+            packed[i / 2] |= std::uint8_t((i % 2) ? (code << 4) : code);
+        }
+        m_stepIndex = stepIndex;
+        break;
+    }
+    }
+}
+
+bool AudioDecoder::decode(AudioCodec codec, const std::uint8_t* data, std::size_t bytes,
+                          std::vector<std::int16_t>& out)
+{
+    out.clear();
+
+    switch (codec) {
+    case AudioCodec::Pcm16:
+        if (bytes % sizeof(std::int16_t) != 0) {
+            return false;
+        }
+        out.resize(bytes / sizeof(std::int16_t));
+        std::memcpy(out.data(), data, bytes);
+        return true;
+
+    case AudioCodec::MuLaw:
+        out.resize(bytes);
+        for (std::size_t i = 0; i < bytes; ++i) {
+            out[i] = mulawDecodeSample(data[i]);
+        }
+        return true;
+
+    case AudioCodec::ImaAdpcm: {
+        if (bytes < ADPCM_HEADER_BYTES || data[2] > ADPCM_MAX_STEP_INDEX || (data[3] & ~ADPCM_FLAG_PADDED)) {
+            return false;
+        }
+        std::size_t codes = (bytes - ADPCM_HEADER_BYTES) * 2;
+        if (data[3] & ADPCM_FLAG_PADDED) {
+            if (codes == 0) {
+                return false;
+            }
+            --codes;
+        }
+
+        int predictor = std::int16_t(data[0] | (data[1] << 8));
+        int stepIndex = data[2];
+        out.resize(codes + 1);
+        out[0] = std::int16_t(predictor);
+
+        const std::uint8_t* packed = data + ADPCM_HEADER_BYTES;
+        for (std::size_t i = 0; i < codes; ++i) {
+            const int code = (i % 2) ? (packed[i / 2] >> 4) : (packed[i / 2] & 0x0f);
+            adpcmStep(code, predictor, stepIndex);
+            out[i + 1] = std::int16_t(predictor);
+        }
+        return true;
+    }
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+#ifndef AUDIO_CODEC_H
+#define AUDIO_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Codecs for the audio sent to the transcription server. Input and output
+// are always mono Int16 at the streamed sample rate.
+//
+// Every encoded message decodes on its own, so frames dropped by the
+// capture ring or suppressed as silence never desynchronise the decoder:
+//   Pcm16     little-endian samples as captured, 1:1
+//   MuLaw     G.711 mu-law, one byte per sample, 2:1
+//   ImaAdpcm  4-byte header (int16 first sample, uint8 step index,
+//             uint8 flags) followed by the remaining samples as 4-bit
+//             codes, low nibble first, about 4:1. Flag bit 0 marks a
+//             padding nibble at the end.
+enum class AudioCodec {
+    Pcm16,
+    MuLaw,
+    ImaAdpcm
+};
+
+const char* audioCodecName(AudioCodec codec);
+bool audioCodecFromName(const std::string& name, AudioCodec& codec);
+
+class AudioEncoder
+{
+public:
+    explicit AudioEncoder(AudioCodec codec = AudioCodec::Pcm16);
+
+    AudioCodec codec() const;
+    void setCodec(AudioCodec codec);
+
+    // Replaces out with one self-contained message.
+    void encode(const std::int16_t* samples, std::size_t count, std::vector<std::uint8_t>& out);
+
+    void reset();
+
+private:
+    AudioCodec m_codec;
+    int m_stepIndex{0}; // ADPCM adaptation carried over as a starting point
+};
+
+class AudioDecoder
+{
+public:
+    // Replaces out with the samples of one message. Returns false when the
+    // message is malformed for the codec.
+    static bool decode(AudioCodec codec, const std::uint8_t* data, std::size_t bytes,
+                       std::vector<std::int16_t>& out);
+};
+
+#endif // AUDIO_CODEC_H
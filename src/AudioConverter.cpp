@@ -0,0 +1,346 @@
+#include "AudioConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AUDIO_CONVERTER_SSE
+#endif
+
+namespace {
+
+// Coefficients per output sample when not decimating; decimation scales
+// this by the rate ratio so the stop band stays the same width.
+constexpr int BASE_TAPS = 16;
+
+// Pass band as a fraction of the lower Nyquist frequency: 7.2 kHz at a
+// 16 kHz output, well above what speech recognition uses.
+constexpr double CUTOFF_FRACTION = 0.9;
+
+constexpr int MAX_CHANNELS = 16;
+constexpr double PI = 3.14159265358979323846;
+
+template <typename T>
+T readSample(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+float sampleToFloat(const char* data, PcmFormat::Sample format) {
+    switch (format) {
+    case PcmFormat::Sample::UInt8:
+        return (static_cast<unsigned char>(*data) - 128) / 128.0f;
+    case PcmFormat::Sample::Int16:
+        return readSample<std::int16_t>(data) / 32768.0f;
+    case PcmFormat::Sample::Int32:
+        return float(readSample<std::int32_t>(data) / 2147483648.0);
+    case PcmFormat::Sample::Float:
+        return readSample<float>(data);
+    }
+    return 0.0f;
+}
+
+} // namespace
+
+int PcmFormat::bytesPerSample() const
+{
+    switch (sample) {
+    case Sample::UInt8:
+        return 1;
+    case Sample::Int16:
+        return 2;
+    case Sample::Int32:
+    case Sample::Float:
+        return 4;
+    }
+    return 0;
+}
+
+int PcmFormat::bytesPerFrame() const
+{
+    return bytesPerSample() * channels;
+}
+
+bool PcmFormat::operator==(const PcmFormat& other) const
+{
+    return sample == other.sample && channels == other.channels && sampleRate == other.sampleRate;
+}
+
+AudioConverter::AudioConverter(const PcmFormat& input, int outputRate)
+    : m_input(input),
+      m_output{PcmFormat::Sample::Int16, 1, outputRate},
+      m_useSimd(simdAvailable())
+{
+    if (input.channels < 1 || input.channels > MAX_CHANNELS ||
+        input.sampleRate <= 0 || outputRate <= 0) {
+        throw std::invalid_argument("Unsupported audio format for conversion");
+    }
+    buildFilter();
+    reset();
+}
+
+const PcmFormat& AudioConverter::inputFormat() const
+{
+    return m_input;
+}
+
+const PcmFormat& AudioConverter::outputFormat() const
+{
+    return m_output;
+}
+
+bool AudioConverter::isPassthrough() const
+{
+    return m_input == m_output;
+}
+
+bool AudioConverter::simdAvailable()
+{
+#ifdef AUDIO_CONVERTER_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AudioConverter::setSimdEnabled(bool enabled)
+{
+    m_useSimd = enabled && simdAvailable();
+}
+
+void AudioConverter::reset()
+{
+    m_work.assign(m_taps - 1, 0.0f);
+    m_position = m_taps - 1;
+    m_phase = 0;
+    m_partialBytes = 0;
+}
+
+std::size_t AudioConverter::maxOutputSamples(std::size_t inputBytes) const
+{
+    const std::size_t frames = (inputBytes + m_partialBytes) / m_input.bytesPerFrame();
+    return frames * m_up / m_down + 1;
+}
+
+void AudioConverter::buildFilter()
+{
+    const int divisor = std::gcd(m_input.sampleRate, m_output.sampleRate);
+    m_up = m_output.sampleRate / divisor;
+    m_down = m_input.sampleRate / divisor;
+
+    if (m_up == m_down) {
+        m_taps = 1;
+        m_coeffs.assign(1, 1.0f);
+        return;
+    }
+
+    // Round up to whole SSE registers; the extra taps are just longer tails
+    const double ratio = std::max(1.0, double(m_down) / m_up);
+    m_taps = (int(std::ceil(BASE_TAPS * ratio)) + 3) & ~3;
+
+    // Windowed-sinc low-pass at the upsampled rate, split into m_up phases
+    const int length = m_taps * m_up;
+    const double cutoff = CUTOFF_FRACTION * 0.5 / std::max(m_up, m_down);
+    const double center = (length - 1) / 2.0;
+
+    std::vector<double> prototype(length);
+    for (int i = 0; i < length; ++i) {
+        const double t = i - center;
+        const double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * PI * cutoff * t) / (PI * t);
+        const double window = 0.42 - 0.5 * std::cos(2.0 * PI * i / (length - 1)) +
+                              0.08 * std::cos(4.0 * PI * i / (length - 1));
+        prototype[i] = sinc * window;
+    }
+
+    m_coeffs.assign(std::size_t(length), 0.0f);
+    for (int phase = 0; phase < m_up; ++phase) {
+        double sum = 0.0;
+        for (int k = 0; k < m_taps; ++k) {
+            sum += prototype[phase + k * m_up];
+        }
+        // Unity gain per phase keeps DC flat; reversed so that row j
+        // multiplies the oldest sample first.
+        for (int k = 0; k < m_taps; ++k) {
+            m_coeffs[phase * m_taps + (m_taps - 1 - k)] = float(prototype[phase + k * m_up] / sum);
+        }
+    }
+}
+
+void AudioConverter::convert(const char* data, std::size_t bytes, std::vector<std::int16_t>& out)
+{
+    out.clear();
+
+    const std::size_t frameBytes = m_input.bytesPerFrame();
+    const bool passthrough = isPassthrough();
+
+    auto appendFrames = [&](const char* frames, std::size_t count) {
+        if (passthrough) {
+            const std::size_t offset = out.size();
+            out.resize(offset + count);
+            std::memcpy(out.data() + offset, frames, count * frameBytes);
+        } else {
+            const std::size_t offset = m_work.size();
+            m_work.resize(offset + count);
+            toMono(frames, count, m_work.data() + offset);
+        }
+    };
+
+    // Complete a frame split across the previous chunk and this one
+    if (m_partialBytes > 0) {
+        const std::size_t needed = std::min(frameBytes - m_partialBytes, bytes);
+        std::memcpy(m_partial.data() + m_partialBytes, data, needed);
+        m_partialBytes += needed;
+        data += needed;
+        bytes -= needed;
+
+        if (m_partialBytes < frameBytes) {
+            return;
+        }
+        appendFrames(m_partial.data(), 1);
+        m_partialBytes = 0;
+    }
+
+    const std::size_t frames = bytes / frameBytes;
+    appendFrames(data, frames);
+
+    m_partialBytes = bytes - frames * frameBytes;
+    std::memcpy(m_partial.data(), data + frames * frameBytes, m_partialBytes);
+
+    if (!passthrough) {
+        resample(out);
+    }
+}
+
+void AudioConverter::resample(std::vector<std::int16_t>& out)
+{
+    const float* samples = m_work.data();
+    const std::size_t available = m_work.size();
+
+    if (m_up == m_down) {
+        out.resize(available);
+        toInt16(samples, available, out.data());
+        m_work.clear();
+        return;
+    }
+
+    m_resampled.clear();
+    while (m_position < available) {
+        m_resampled.push_back(dot(&m_coeffs[std::size_t(m_phase) * m_taps],
+                                  samples + m_position - (m_taps - 1)));
+        m_phase += m_down;
+        m_position += m_phase / m_up;
+        m_phase %= m_up;
+    }
+
+    // Keep the last m_taps - 1 samples as history for the next chunk
+    const std::size_t consumed = available - (m_taps - 1);
+    m_work.erase(m_work.begin(), m_work.begin() + consumed);
+    m_position -= consumed;
+
+    out.resize(m_resampled.size());
+    toInt16(m_resampled.data(), m_resampled.size(), out.data());
+}
+
+void AudioConverter::toMono(const char* data, std::size_t frames, float* mono) const
+{
+    const int channels = m_input.channels;
+    std::size_t i = 0;
+
+#ifdef AUDIO_CONVERTER_SSE
+    if (m_useSimd && m_input.sample == PcmFormat::Sample::Float && channels == 2) {
+        // Four stereo frames per step: de-interleave and average
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; i + 4 <= frames; i += 4) {
+            const float* src = reinterpret_cast<const float*>(data) + i * 2;
+            const __m128 a = _mm_loadu_ps(src);
+            const __m128 b = _mm_loadu_ps(src + 4);
+            const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+    } else if (m_useSimd && m_input.sample == PcmFormat::Sample::Int16 && channels == 2) {
+        // madd against ones sums each left/right pair into an int32
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128 scale = _mm_set1_ps(1.0f / 65536.0f);
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+            const __m128i sums = _mm_madd_epi16(pcm, ones);
+            _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_cvtepi32_ps(sums), scale));
+        }
+    } else if (m_useSimd && m_input.sample == PcmFormat::Sample::Int16 && channels == 1) {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+            _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+            _mm_storeu_ps(mono + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+        }
+    }
+#endif
+
+    const int sampleBytes = m_input.bytesPerSample();
+    const float channelScale = 1.0f / channels;
+    for (; i < frames; ++i) {
+        const char* frame = data + i * std::size_t(m_input.bytesPerFrame());
+        float sum = 0.0f;
+        for (int channel = 0; channel < channels; ++channel) {
+            sum += sampleToFloat(frame + channel * sampleBytes, m_input.sample);
+        }
+        mono[i] = sum * channelScale;
+    }
+}
+
+void AudioConverter::toInt16(const float* samples, std::size_t count, std::int16_t* out) const
+{
+    std::size_t i = 0;
+
+#ifdef AUDIO_CONVERTER_SSE
+    if (m_useSimd) {
+        // Clamp first: cvtps turns out-of-range values into INT_MIN
+        const __m128 scale = _mm_set1_ps(32767.0f);
+        const __m128 upper = _mm_set1_ps(1.0f);
+        const __m128 lower = _mm_set1_ps(-1.0f);
+        for (; i + 8 <= count; i += 8) {
+            const __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(samples + i), upper), lower);
+            const __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(samples + i + 4), upper), lower);
+            const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)),
+                                                   _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const float clamped = std::clamp(samples[i], -1.0f, 1.0f);
+        out[i] = std::int16_t(std::lrint(clamped * 32767.0f));
+    }
+}
+
+float AudioConverter::dot(const float* coeffs, const float* samples) const
+{
+    int k = 0;
+    float sum = 0.0f;
+
+#ifdef AUDIO_CONVERTER_SSE
+    if (m_useSimd) {
+        __m128 acc = _mm_setzero_ps();
+        for (; k + 4 <= m_taps; k += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(coeffs + k), _mm_loadu_ps(samples + k)));
+        }
+        // Horizontal sum of the four lanes
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        sum = _mm_cvtss_f32(acc);
+    }
+#endif
+
+    for (; k < m_taps; ++k) {
+        sum += coeffs[k] * samples[k];
+    }
+    return sum;
+}
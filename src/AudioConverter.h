@@ -0,0 +1,92 @@
+#ifndef AUDIO_CONVERTER_H
+#define AUDIO_CONVERTER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Layout of interleaved PCM, independent of Qt Multimedia so the DSP code
+// can be built and benchmarked without an audio backend.
+struct PcmFormat {
+    enum class Sample {
+        UInt8,
+        Int16,
+        Int32,
+        Float
+    };
+
+    Sample sample{Sample::Int16};
+    int channels{1};
+    int sampleRate{16000};
+
+    int bytesPerSample() const;
+    int bytesPerFrame() const;
+    bool operator==(const PcmFormat& other) const;
+};
+
+// Turns whatever the capture device delivers into mono Int16 at a fixed
+// rate: samples are converted to float, channels averaged, the rate changed
+// with a polyphase windowed-sinc filter and the result saturated back to
+// Int16. The hot loops use SSE when the target has it.
+//
+// convert() may be called with arbitrary chunk sizes, including partial
+// frames; filter history is kept between calls. Not thread-safe.
+class AudioConverter
+{
+public:
+    static constexpr int DEFAULT_OUTPUT_RATE = 16000;
+
+    explicit AudioConverter(const PcmFormat& input, int outputRate = DEFAULT_OUTPUT_RATE);
+
+    const PcmFormat& inputFormat() const;
+    const PcmFormat& outputFormat() const;
+
+    // True when the input already is the output format and convert() would
+    // only copy.
+    bool isPassthrough() const;
+
+    // Replaces out with the converted samples of the next input chunk.
+    void convert(const char* data, std::size_t bytes, std::vector<std::int16_t>& out);
+
+    // Upper bound for the samples convert() produces for a chunk, for
+    // reserving the output vector up front.
+    std::size_t maxOutputSamples(std::size_t inputBytes) const;
+
+    // Drops filter history and any buffered partial frame.
+    void reset();
+
+    // Benchmarks compare the vector and scalar paths; SSE is used whenever
+    // the target supports it unless disabled here.
+    static bool simdAvailable();
+    void setSimdEnabled(bool enabled);
+
+private:
+    void buildFilter();
+    void toMono(const char* data, std::size_t frames, float* mono) const;
+    void resample(std::vector<std::int16_t>& out);
+    void toInt16(const float* samples, std::size_t count, std::int16_t* out) const;
+    float dot(const float* coeffs, const float* samples) const;
+
+    PcmFormat m_input;
+    PcmFormat m_output;
+    bool m_useSimd;
+
+    // Rate change by m_up / m_down, m_taps coefficients per phase stored in
+    // m_coeffs as m_up consecutive rows, reversed for a forward dot product.
+    int m_up{1};
+    int m_down{1};
+    int m_taps{1};
+    std::vector<float> m_coeffs;
+
+    // m_taps - 1 samples of history followed by the current chunk
+    std::vector<float> m_work;
+    std::size_t m_position{0};
+    int m_phase{0};
+
+    std::vector<float> m_resampled;
+    std::array<char, 64> m_partial{};
+    std::size_t m_partialBytes{0};
+};
+
+#endif // AUDIO_CONVERTER_H
@@ -1,24 +1,16 @@
 #include "AudioStreamer.h"
 #include <QDebug>
 #include <QMediaDevices>
+#include <algorithm>
+#include <cstring>
 
 AudioStreamer::AudioStreamer(QObject *parent)
     : QIODevice(parent)
 {
-    // Initialize with optimal settings for speech recognition
-    m_format.setSampleRate(16000);  // Standard for speech processing
-    m_format.setChannelCount(1);    // Mono
-    m_format.setSampleFormat(QAudioFormat::Int16);
+    configureFormat();
 
-    // Verify and adjust format based on device capabilities
-    const QAudioDevice device = QMediaDevices::defaultAudioInput();
-    if (!device.isFormatSupported(m_format)) {
-        qWarning() << "Default format not supported, using nearest supported format";
-        m_format = device.preferredFormat();
-    }
-
-    m_audioInput = std::make_unique<QAudioSource>(device, m_format);
-    m_audioInput->setBufferSize(m_format.bytesForDuration(100000)); // 100ms buffer
+    // The QAudioSource itself is created in startRecording() so that it
+    // belongs to the capture thread.
 }
 
 AudioStreamer::~AudioStreamer()
@@ -26,12 +18,23 @@ AudioStreamer::~AudioStreamer()
     stopRecording();
 }
 
+void AudioStreamer::setFramesReadyHandler(std::function<void()> handler)
+{
+    m_framesReady = std::move(handler);
+}
+
 void AudioStreamer::startRecording()
 {
     if (!isOpen()) {
+        if (!m_audioInput) {
+            m_audioInput = std::make_unique<QAudioSource>(QMediaDevices::defaultAudioInput(), m_deviceFormat);
+            m_audioInput->setBufferSize(m_deviceFormat.bytesForDuration(100000)); // 100ms buffer
+        }
+
         open(QIODevice::WriteOnly);
         m_audioInput->start(this);
-        qDebug() << "Recording started with sample rate:" << m_format.sampleRate();
+        qDebug() << "Recording started with device format:" << m_deviceFormat
+                 << "streaming at" << m_outputRate << "Hz mono Int16";
     }
 }
 
@@ -46,22 +49,19 @@ void AudioStreamer::stopRecording()
 
 bool AudioStreamer::isRecording() const
 {
-    return isOpen() && (m_audioInput->state() == QAudio::ActiveState);
+    return isOpen() && m_audioInput && (m_audioInput->state() == QAudio::ActiveState);
 }
 
 void AudioStreamer::setSampleRate(int rate)
 {
-    if (m_format.sampleRate() != rate) {
-        m_format.setSampleRate(rate);
-        const QAudioDevice device = QMediaDevices::defaultAudioInput();
-        if (!device.isFormatSupported(m_format)) {
-            qWarning() << "Requested sample rate not supported, using device default";
-            m_format = device.preferredFormat();
-        }
+    if (m_outputRate != rate) {
+        m_outputRate = rate;
 
-        if (isRecording()) {
-            stopRecording();
-            m_audioInput = std::make_unique<QAudioSource>(device, m_format);
+        const bool wasRecording = isRecording();
+        stopRecording();
+        m_audioInput.reset();
+        configureFormat();
+        if (wasRecording) {
             startRecording();
         }
     }
@@ -69,7 +69,76 @@ void AudioStreamer::setSampleRate(int rate)
 
 int AudioStreamer::sampleRate() const
 {
-    return m_format.sampleRate();
+    return m_outputRate;
+}
+
+QAudioFormat AudioStreamer::format() const
+{
+    QAudioFormat format;
+    format.setSampleRate(m_outputRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+QAudioFormat AudioStreamer::deviceFormat() const
+{
+    return m_deviceFormat;
+}
+
+void AudioStreamer::configureFormat()
+{
+    // Capture in the streamed format when the device can, so the converter
+    // is a plain copy.
+    m_deviceFormat = format();
+
+    const QAudioDevice device = QMediaDevices::defaultAudioInput();
+    if (!device.isFormatSupported(m_deviceFormat)) {
+        m_deviceFormat = device.preferredFormat();
+        qDebug() << "Capturing in device format" << m_deviceFormat << "and converting";
+    }
+
+    m_converter.reset();
+    PcmFormat input;
+    input.channels = m_deviceFormat.channelCount();
+    input.sampleRate = m_deviceFormat.sampleRate();
+    switch (m_deviceFormat.sampleFormat()) {
+    case QAudioFormat::UInt8:
+        input.sample = PcmFormat::Sample::UInt8;
+        break;
+    case QAudioFormat::Int16:
+        input.sample = PcmFormat::Sample::Int16;
+        break;
+    case QAudioFormat::Int32:
+        input.sample = PcmFormat::Sample::Int32;
+        break;
+    case QAudioFormat::Float:
+        input.sample = PcmFormat::Sample::Float;
+        break;
+    default:
+        qWarning() << "Unsupported capture format" << m_deviceFormat << "- audio will not be streamed";
+        return;
+    }
+
+    try {
+        m_converter = std::make_unique<AudioConverter>(input, m_outputRate);
+    } catch (const std::exception& e) {
+        qWarning() << "Audio conversion unavailable:" << e.what();
+        return;
+    }
+
+    // Sized for the largest chunk QAudioSource delivers, so conversion does
+    // not allocate while recording.
+    m_converted.reserve(m_converter->maxOutputSamples(m_deviceFormat.bytesForDuration(500000)));
+}
+
+AudioStreamer::Stats AudioStreamer::stats() const
+{
+    Stats stats;
+    stats.framesCaptured = m_framesCaptured.load(std::memory_order_relaxed);
+    stats.framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+    stats.overruns = m_overruns.load(std::memory_order_relaxed);
+    return stats;
 }
 
 qint64 AudioStreamer::readData(char *data, qint64 maxlen)
@@ -81,13 +150,55 @@ qint64 AudioStreamer::readData(char *data, qint64 maxlen)
 
 qint64 AudioStreamer::writeData(const char *data, qint64 len)
 {
-    // Store the incoming audio data
-    const QByteArray newData(data, len);
-    m_buffer.append(newData);
+    // Runs on the capture thread
+    if (!m_converter) {
+        return len;
+    }
 
-    // Emit signal with the new data
-    emit audioDataReady(newData);
+    qint64 queued;
+    if (m_converter->isPassthrough()) {
+        queued = enqueue(data, len);
+    } else {
+        m_converter->convert(data, std::size_t(len), m_converted);
+        queued = enqueue(reinterpret_cast<const char*>(m_converted.data()),
+                         qint64(m_converted.size() * sizeof(std::int16_t)));
+    }
+
+    if (queued > 0 && !m_notifyPending.exchange(true) && m_framesReady) {
+        m_framesReady();
+    }
 
     // Return number of bytes processed
     return len;
 }
+
+qint64 AudioStreamer::enqueue(const char *data, qint64 len)
+{
+    // Copy straight into preallocated ring slots; when the consumer falls
+    // behind, the newest audio is dropped.
+    qint64 offset = 0;
+    while (offset < len) {
+        AudioFrame* frame = m_frames.acquire();
+        if (!frame) {
+            const qint64 remaining = len - offset;
+            m_framesDropped.fetch_add((remaining + AudioFrame::CAPACITY - 1) / AudioFrame::CAPACITY,
+                                      std::memory_order_relaxed);
+            if (!m_overflowing) {
+                m_overflowing = true;
+                m_overruns.fetch_add(1, std::memory_order_relaxed);
+                qWarning() << "Audio ring buffer full, dropping frames";
+            }
+            break;
+        }
+
+        const qint64 chunk = std::min(len - offset, AudioFrame::CAPACITY);
+        std::memcpy(frame->data.data(), data + offset, chunk);
+        frame->size = chunk;
+        m_frames.publish();
+
+        offset += chunk;
+        m_overflowing = false;
+        m_framesCaptured.fetch_add(1, std::memory_order_relaxed);
+    }
+    return offset;
+}
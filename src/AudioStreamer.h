@@ -5,26 +5,70 @@
 #include <QAudioSource>
 #include <QMediaDevices>
 #include <QAudioFormat>
-#include <QByteArray>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <type_traits>
+#include "AudioConverter.h"
+#include "SpscRingBuffer.h"
 
+// One chunk of captured PCM. Chunks delivered by QAudioSource that are
+// larger than CAPACITY are split across several frames.
+struct AudioFrame {
+    static constexpr qint64 CAPACITY = 4096;
+
+    alignas(std::int16_t) std::array<char, CAPACITY> data;
+    qint64 size{0};
+};
+
+// Captures the default input device into a fixed-size ring of AudioFrames.
+// Whatever the device delivers, the frames hold mono Int16 PCM at
+// sampleRate() (16 kHz unless changed); conversion happens on the capture
+// thread.
+//
+// The streamer is meant to live on its own thread (see startRecording), so
+// GUI stalls never delay capture. The consumer is woken through the
+// callback passed to setFramesReadyHandler and drains the ring with
+// consumeFrames(); nothing on this path allocates per chunk.
 class AudioStreamer : public QIODevice
 {
     Q_OBJECT
 
 public:
+    struct Stats {
+        quint64 framesCaptured{0};
+        quint64 framesDropped{0};   // lost because the ring was full
+        quint64 overruns{0};        // times the consumer fell behind
+    };
+
     explicit AudioStreamer(QObject *parent = nullptr);
     ~AudioStreamer();
 
-    void startRecording();
-    void stopRecording();
     bool isRecording() const;
-
-    void setSampleRate(int rate);
     int sampleRate() const;
+    QAudioFormat format() const;        // what the frames contain
+    QAudioFormat deviceFormat() const;  // what is captured
+    Stats stats() const;
+
+    // Called on the capture thread whenever frames become available after
+    // the consumer has drained the ring. Set before recording starts.
+    void setFramesReadyHandler(std::function<void()> handler);
+
+    // Consumer side: hands every queued frame to consume(const AudioFrame&).
+    // A consume that returns bool can stop early by returning false; the
+    // frame stays queued and no new notification comes until the consumer
+    // calls consumeFrames() again.
+    template <typename Fn>
+    void consumeFrames(Fn&& consume);
+
+public slots:
+    // Slots so they can be invoked on the capture thread
+    void startRecording();
+    void stopRecording();
+    void setSampleRate(int rate);       // of the streamed audio
 
 signals:
-    void audioDataReady(const QByteArray &data);
     void errorOccurred(const QString &message);
 
 protected:
@@ -32,9 +76,51 @@ protected:
     qint64 writeData(const char *data, qint64 len) override;
 
 private:
+    static constexpr std::size_t RING_FRAMES = 256;
+
+    void configureFormat();
+    qint64 enqueue(const char *data, qint64 len);
+
     std::unique_ptr<QAudioSource> m_audioInput;
-    QAudioFormat m_format;
-    QByteArray m_buffer;
+    QAudioFormat m_deviceFormat;
+    int m_outputRate{AudioConverter::DEFAULT_OUTPUT_RATE};
+    std::unique_ptr<AudioConverter> m_converter;
+    std::vector<std::int16_t> m_converted;
+
+    SpscRingBuffer<AudioFrame, RING_FRAMES> m_frames;
+    std::function<void()> m_framesReady;
+    std::atomic<bool> m_notifyPending{false};
+    bool m_overflowing{false};
+
+    std::atomic<quint64> m_framesCaptured{0};
+    std::atomic<quint64> m_framesDropped{0};
+    std::atomic<quint64> m_overruns{0};
 };
 
+template <typename Fn>
+void AudioStreamer::consumeFrames(Fn&& consume)
+{
+    for (;;) {
+        while (const AudioFrame* frame = m_frames.front()) {
+            if constexpr (std::is_same_v<std::invoke_result_t<Fn&, const AudioFrame&>, bool>) {
+                if (!consume(*frame)) {
+                    return;
+                }
+            } else {
+                consume(*frame);
+            }
+            m_frames.release();
+        }
+
+        m_notifyPending.store(false);
+
+        // A frame may have been published between the last front() and
+        // clearing the flag; keep going unless the producer already posted
+        // a new notification for it.
+        if (m_frames.empty() || m_notifyPending.exchange(true)) {
+            return;
+        }
+    }
+}
+
 #endif // AUDIOSTREAMER_H
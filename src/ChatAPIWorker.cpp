@@ -1,84 +1,453 @@
 #include "ChatAPIWorker.h"
+#include "ImageEncoder.h"
+#include "Metrics.h"
+#include "ProviderConfig.h"
+#include "ResponseCache.h"
+#include "SseParser.h"
 #include "chat_api.h"
 #include "config.h"
 #include <QTimer>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSslConfiguration>
 #include <exception>
 #include <qimage.h>
-#include <qpixmap.h>
 #include <qthread.h>
-#include <QBuffer>
 
-std::string encodePixmapToBase64(const QPixmap& pixmap, const char* format = "PNG", int quality = 80) {
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    buffer.open(QIODevice::WriteOnly);
+namespace {
+
+// Below the idle timeout of the providers' load balancers
+constexpr int KEEP_ALIVE_INTERVAL_MS = 45000;
+
+struct WorkerMetrics {
+    MetricCounter& requests = MetricsRegistry::global().counter(
+        "qhyni_chat_requests_total", "Requests processed by the chat workers");
+    MetricCounter& errors = MetricsRegistry::global().counter(
+        "qhyni_chat_errors_total", "Requests that failed");
+    MetricCounter& cacheHits = MetricsRegistry::global().counter(
+        "qhyni_chat_cache_hits_total", "Requests answered from the response cache");
+    LatencyHistogram& imageEncode = MetricsRegistry::global().histogram(
+        "qhyni_image_encode_seconds", "Downscaling and encoding a screenshot to base64");
+    LatencyHistogram& streamFirstByte = MetricsRegistry::global().histogram(
+        "qhyni_http_stream_first_byte_seconds", "Streaming request sent until the first bytes of the answer");
+    LatencyHistogram& streamRoundTrip = MetricsRegistry::global().histogram(
+        "qhyni_http_stream_seconds", "Streaming request sent until the answer is complete");
+    LatencyHistogram& sendImage = MetricsRegistry::global().histogram(
+        "qhyni_http_send_image_seconds", "Round trip of hyni::chat_api::send_image");
+    LatencyHistogram& sendMessage = MetricsRegistry::global().histogram(
+        "qhyni_http_send_message_seconds", "Round trip of hyni::chat_api::send_message");
+    LatencyHistogram& assistantReply = MetricsRegistry::global().histogram(
+        "qhyni_assistant_reply_seconds", "Extracting the answer with get_assistant_reply");
+    MetricCounter& warmups = MetricsRegistry::global().counter(
+        "qhyni_http_warmups_total", "Connections to a provider opened or kept open ahead of requests");
+};
+
+WorkerMetrics& metrics() {
+    static WorkerMetrics metrics;
+    return metrics;
+}
 
-    if (!pixmap.save(&buffer, format, quality)) {
-        throw std::runtime_error("Failed to save QPixmap to buffer.");
-    }
+// Only the prompt hyni::chat_api is given as well; its own system prompts
+// are not reachable from here, so none is added.
+QJsonArray textMessages(const QString& prompt) {
+    return QJsonArray{
+        QJsonObject{{"role", "user"}, {"content", prompt}}
+    };
+}
 
-    return byteArray.toBase64().toStdString();
+QJsonArray imageMessages(const QString& prompt,
+                         const QByteArray& base64Image,
+                         const QByteArray& mimeType) {
+    const QString dataUrl = "data:" + QString::fromLatin1(mimeType) + ";base64," +
+                            QString::fromLatin1(base64Image);
+    const QJsonArray content{
+        QJsonObject{{"type", "text"}, {"text", prompt}},
+        QJsonObject{{"type", "image_url"}, {"image_url", QJsonObject{{"url", dataUrl}}}}
+    };
+    return QJsonArray{
+        QJsonObject{{"role", "user"}, {"content", content}}
+    };
 }
 
+} // namespace
+
+// A streamed answer in flight; the worker stays busy until its reply ends
+struct ChatAPIWorker::Stream {
+    quint64 requestId{0};
+    QNetworkReply* reply{nullptr};
+    SseParser parser;
+    QString text;
+    QByteArray cacheKey;
+    QString apiName;  // for error messages
+    QElapsedTimer sent;
+    bool firstBytes{true};
+};
+
 ChatAPIWorker::ChatAPIWorker(QObject *parent)
     : QObject(parent),
-    m_isBusy(false),
     m_cancelRequested(false) {
     try {
-        m_chatAPI = std::make_unique<hyni::chat_api>(hyni::GPT_API_URL);
-        if (!m_chatAPI->has_api_key()) {
+        auto chatAPI = std::make_unique<hyni::chat_api>(hyni::GPT_API_URL);
+        const hyni::chat_api::API_PROVIDER provider = chatAPI->get_api_provider();
+        m_selectedAPI.store(chatAPI.get());
+        m_chatAPIs[provider] = std::move(chatAPI);
+        if (!api()->has_api_key()) {
             QTimer::singleShot(2000, [this]() {
                 emit needApiKey();
             });
         }
     } catch (const std::exception& e) {
         qCritical() << "API init failed:" << e.what();
-        emit errorOccurred(QString("API initialization failed: %1").arg(e.what()));
+        emit errorOccurred(0, QString("API initialization failed: %1").arg(e.what()));
     }
 }
 
 ChatAPIWorker::~ChatAPIWorker() {
     if (QThread::currentThread() == this->thread()) {
         // Direct deletion if already in correct thread
-        m_chatAPI.reset();
+        m_selectedAPI.store(nullptr);
+        m_chatAPIs.clear();
     } else {
         // Non-blocking deferred deletion
         QMetaObject::invokeMethod(this, [this]() {
-            m_chatAPI.reset();
+            m_selectedAPI.store(nullptr);
+            m_chatAPIs.clear();
         }, Qt::QueuedConnection);
     }
 }
 
 hyni::chat_api::API_PROVIDER ChatAPIWorker::getProvider() const {
-    return m_chatAPI ? m_chatAPI->get_api_provider() :
+    const hyni::chat_api* chatAPI = api();
+    return chatAPI ? chatAPI->get_api_provider() :
         hyni::chat_api::API_PROVIDER::Unknown;
 }
 
+hyni::chat_api* ChatAPIWorker::api() const {
+    hyni::chat_api* active = m_activeAPI.load();
+    return active ? active : m_selectedAPI.load();
+}
+
+// One long-lived client per provider, so switching back and forth keeps
+// whatever connections they hold. The selected one unless the request
+// names another provider.
+hyni::chat_api* ChatAPIWorker::apiFor(hyni::chat_api::API_PROVIDER provider) {
+    if (provider == hyni::chat_api::API_PROVIDER::Unknown) {
+        return m_selectedAPI.load();
+    }
+    std::unique_ptr<hyni::chat_api>& chatAPI = m_chatAPIs[provider];
+    if (!chatAPI) {
+        chatAPI = std::make_unique<hyni::chat_api>(provider);
+        const auto key = m_apiKeys.find(provider);
+        if (key != m_apiKeys.end()) {
+            chatAPI->set_api_key(key->second.toStdString());
+        }
+    }
+    return chatAPI.get();
+}
+
 void ChatAPIWorker::setProvider(hyni::chat_api::API_PROVIDER provider) {
-    if (m_chatAPI->get_api_provider() != provider) {
-        m_chatAPI.reset(new hyni::chat_api(provider));
+    m_selectedAPI.store(apiFor(provider));
+}
+
+// Opens the connection the next streaming request to the provider will use
+// and keeps it open from now on, so no question pays for DNS, TCP and TLS.
+// hyni::chat_api has connections of its own, so this waits until streaming
+// is turned on.
+void ChatAPIWorker::warmUp(hyni::chat_api::API_PROVIDER provider) {
+    m_warmProviders.insert(provider);
+    if (m_streamingEnabled.load()) {
+        startKeepAlive();
+        connectAhead(provider);
     }
 }
 
-void ChatAPIWorker::sendImageRequest(const QPixmap& pixmap,
-                                     const QString& language,
-                                     hyni::chat_api::QUESTION_TYPE type) {
-    if (m_isBusy.exchange(true)) {
-        qDebug() << "Image request ignored - worker busy";
+void ChatAPIWorker::startKeepAlive() {
+    // Created here, in the worker thread, like m_network
+    if (!m_keepAliveTimer) {
+        m_keepAliveTimer = new QTimer(this);
+        m_keepAliveTimer->setInterval(KEEP_ALIVE_INTERVAL_MS);
+        connect(m_keepAliveTimer, &QTimer::timeout, this, &ChatAPIWorker::keepAlive);
+    }
+    if (!m_keepAliveTimer->isActive()) {
+        m_keepAliveTimer->start();
+    }
+}
+
+// In the worker thread, after setStreamingEnabled()
+void ChatAPIWorker::applyStreamingEnabled() {
+    if (!m_streamingEnabled.load()) {
+        if (m_keepAliveTimer) {
+            m_keepAliveTimer->stop();
+        }
+        return;
+    }
+    if (m_warmProviders.empty()) {
         return;
     }
+    startKeepAlive();
+    for (hyni::chat_api::API_PROVIDER provider : m_warmProviders) {
+        connectAhead(provider);
+    }
+}
 
-    if (!m_chatAPI->has_api_key()) {
-        emit needApiKey();
+void ChatAPIWorker::connectAhead(hyni::chat_api::API_PROVIDER provider) {
+    const QUrl url = providerEndpoint(provider).url;
+    if (!m_network) {
+        m_network = new QNetworkAccessManager(this);
+    }
+
+    metrics().warmups.add();
+#if QT_CONFIG(ssl)
+    if (url.scheme() == "https") {
+        // Requests may use HTTP/2, which a connection can only get from ALPN
+        QSslConfiguration ssl = QSslConfiguration::defaultConfiguration();
+        ssl.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                     QSslConfiguration::NextProtocolHttp1_1});
+        m_network->connectToHostEncrypted(url.host(), quint16(url.port(443)), ssl);
         return;
     }
+#endif
+    m_network->connectToHost(url.host(), quint16(url.port(80)));
+}
 
-    m_cancelRequested.store(false);
+// Servers drop idle connections after a minute or so; reopening them while
+// idle costs nothing a question would notice.
+void ChatAPIWorker::keepAlive() {
+    if (m_activeRequestId.load() != 0 ||
+        (m_lastRequest.isValid() && m_lastRequest.elapsed() < KEEP_ALIVE_INTERVAL_MS)) {
+        return;
+    }
+    for (hyni::chat_api::API_PROVIDER provider : m_warmProviders) {
+        connectAhead(provider);
+    }
+}
+
+void ChatAPIWorker::processRequest(const ChatRequest& request) {
+    m_activeAPI.store(apiFor(request.provider));
+    m_activeRequestId.store(request.id);
+    m_cancelRequested.store(m_cancelTargetId.load() == request.id);
+    metrics().requests.add();
+
+    bool streaming = false;
+    switch (request.kind) {
+    case ChatRequest::Kind::Image:
+        streaming = sendImageRequest(request.id, request.image, request.language, request.type);
+        break;
+    case ChatRequest::Kind::ResendImage:
+        streaming = resendImageRequest(request.id, request.base64Image, request.imageMimeType,
+                                       request.language, request.type);
+        break;
+    case ChatRequest::Kind::Text:
+        streaming = sendRequest(request.id, request.message, request.type);
+        break;
+    }
+
+    // A streamed answer finishes the request once its reply ends
+    if (!streaming) {
+        finishRequest(request.id);
+    }
+}
+
+void ChatAPIWorker::finishRequest(quint64 requestId) {
+    m_activeRequestId.store(0);
+    m_activeAPI.store(nullptr);
+    m_lastRequest.start();
+    emit requestFinished(requestId);
+}
 
+void ChatAPIWorker::setResponseCache(std::shared_ptr<ResponseCache> cache) {
+    m_cache = std::move(cache);
+}
+
+bool ChatAPIWorker::replyFromCache(quint64 requestId, const QByteArray& cacheKey) {
+    QString cached;
+    if (!m_cache || !m_cache->lookup(cacheKey, cached)) {
+        return false;
+    }
+
+    qDebug() << "Response served from cache";
+    metrics().cacheHits.add();
+    emit responseReceived(requestId, cached, true);
+    return true;
+}
+
+void ChatAPIWorker::storeInCache(const QByteArray& cacheKey, const QString& reply) {
+    if (m_cache) {
+        m_cache->insert(cacheKey, reply);
+    }
+}
+
+void ChatAPIWorker::setStreamingEnabled(bool enabled) {
+    if (m_streamingEnabled.exchange(enabled) == enabled) {
+        return;
+    }
+    // The keep-alive timer belongs to the worker thread
+    QMetaObject::invokeMethod(this, &ChatAPIWorker::applyStreamingEnabled, Qt::QueuedConnection);
+}
+
+// Whether an image request goes out streamed, the only path that sends the
+// image's MIME type along
+bool ChatAPIWorker::streamsImages() const {
+    return m_streamingEnabled.load() && providerEndpoint(getProvider()).supportsImages &&
+           !streamingApiKey().isEmpty();
+}
+
+// The key entered for the provider, else its environment variable
+QString ChatAPIWorker::streamingApiKey() const {
+    const hyni::chat_api::API_PROVIDER provider = getProvider();
+    const auto it = m_apiKeys.find(provider);
+    if (it != m_apiKeys.end() && !it->second.isEmpty()) {
+        return it->second;
+    }
+    return qEnvironmentVariable(providerEndpoint(provider).apiKeyEnv);
+}
+
+// Sends the request with "stream": true and returns right away; the deltas
+// are emitted as they arrive and finishStream() completes the request.
+// Returns false when streaming can't be used (disabled, or no API key known
+// to us), in which case the caller falls back to hyni::chat_api.
+bool ChatAPIWorker::startStream(quint64 requestId,
+                                const QJsonArray& messages,
+                                int maxTokens,
+                                double temperature,
+                                const QByteArray& cacheKey,
+                                const QString& apiName) {
+    if (!m_streamingEnabled.load()) {
+        return false;
+    }
+
+    const ProviderEndpoint endpoint = providerEndpoint(getProvider());
+    const QString apiKey = streamingApiKey();
+    if (apiKey.isEmpty()) {
+        return false;
+    }
+
+    // Created lazily so it lives in the worker thread
+    if (!m_network) {
+        m_network = new QNetworkAccessManager(this);
+    }
+
+    QNetworkRequest request(endpoint.url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", "Bearer " + apiKey.toUtf8());
+    request.setRawHeader("Accept", "text/event-stream");
+
+    const QJsonObject body{
+        {"model", endpoint.model},
+        {"messages", messages},
+        {"max_tokens", maxTokens},
+        {"temperature", temperature},
+        {"stream", true}
+    };
+
+    m_stream = std::make_unique<Stream>();
+    m_stream->requestId = requestId;
+    m_stream->cacheKey = cacheKey;
+    m_stream->apiName = apiName;
+    m_stream->sent.start();
+    m_stream->reply = m_network->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+
+    connect(m_stream->reply, &QNetworkReply::readyRead, this, &ChatAPIWorker::readStream);
+    connect(m_stream->reply, &QNetworkReply::finished, this, &ChatAPIWorker::finishStream);
+    return true;
+}
+
+void ChatAPIWorker::readStream() {
+    if (!m_stream) {
+        return;
+    }
+    if (m_stream->firstBytes) {
+        metrics().streamFirstByte.record(std::chrono::nanoseconds(m_stream->sent.nsecsElapsed()));
+        m_stream->firstBytes = false;
+    }
+    Stream& stream = *m_stream;
+    stream.parser.feed(stream.reply->readAll(), [this, &stream](const QByteArray& data) {
+        appendStreamEvent(stream, data);
+    });
+}
+
+void ChatAPIWorker::appendStreamEvent(Stream& stream, const QByteArray& data) {
+    if (data == "[DONE]") {
+        return;
+    }
+    const QJsonObject chunk = QJsonDocument::fromJson(data).object();
+    const QString delta = chunk.value("choices").toArray().at(0).toObject()
+                              .value("delta").toObject()
+                              .value("content").toString();
+    if (!delta.isEmpty()) {
+        stream.text += delta;
+        emit partialResponseReceived(stream.requestId, delta);
+    }
+}
+
+void ChatAPIWorker::finishStream() {
+    // Taken first: aborting the reply from abortStream() lands here too
+    const std::unique_ptr<Stream> stream = std::move(m_stream);
+    if (!stream) {
+        return;
+    }
+
+    stream->parser.feed(stream->reply->readAll(), [this, &stream](const QByteArray& data) {
+        appendStreamEvent(*stream, data);
+    });
+    stream->parser.finish([this, &stream](const QByteArray& data) {
+        appendStreamEvent(*stream, data);
+    });
+    metrics().streamRoundTrip.record(std::chrono::nanoseconds(stream->sent.nsecsElapsed()));
+
+    const QNetworkReply::NetworkError error = stream->reply->error();
+    const QString errorString = stream->reply->errorString();
+    stream->reply->deleteLater();
+
+    if (m_cancelRequested.load()) {
+        emit requestCancelled(stream->requestId);
+    } else if (error != QNetworkReply::NoError) {
+        metrics().errors.add();
+        qWarning().noquote() << stream->apiName << "error:" << errorString;
+        emit errorOccurred(stream->requestId,
+                           QString("%1 request failed: %2").arg(stream->apiName, errorString));
+    } else {
+        storeInCache(stream->cacheKey, stream->text);
+        emit responseReceived(stream->requestId, stream->text, false);
+    }
+    finishRequest(stream->requestId);
+}
+
+// Runs in the worker thread, queued by cancelCurrentRequest()
+void ChatAPIWorker::abortStream(quint64 requestId) {
+    if (m_stream && m_stream->requestId == requestId) {
+        m_stream->reply->abort();
+    }
+}
+
+bool ChatAPIWorker::sendImageRequest(quint64 requestId,
+                                     const QImage& image,
+                                     const QString& language,
+                                     hyni::chat_api::QUESTION_TYPE type) {
+    if (!api()->has_api_key()) {
+        emit needApiKey();
+        return false;
+    }
+
+    bool streaming = false;
     try {
-        // Encode QPixmap to base64 JPEG
-        m_base64Image = encodePixmapToBase64(pixmap, "PNG", 80);
+        // Downscale and pick the format for this question type.
+        // hyni::chat_api::send_image can't be told the MIME type and has only
+        // ever been given PNG, so lossy formats are left to the streaming path.
+        ImageEncodeProfile profile = ImageEncodeProfile::forQuestionType(type);
+        profile.allowLossy = streamsImages();
+        const EncodedImage encoded = ImageEncoder::encode(image, profile);
+        const QByteArray& base64Image = encoded.base64;
+        qDebug() << "Encoded screenshot" << image.size() << "->" << encoded.size
+                 << encoded.mimeType << encoded.encodedBytes << "bytes in"
+                 << encoded.encodeMicros / 1000.0 << "ms";
+        metrics().imageEncode.record(std::chrono::microseconds(encoded.encodeMicros));
+        emit imageEncoded(requestId, base64Image, encoded.mimeType);
 
         const bool wasCancelled = [&]() {
             if (m_cancelRequested.load()) return true;
@@ -96,57 +465,83 @@ void ChatAPIWorker::sendImageRequest(const QPixmap& pixmap,
 
             qDebug() << enhancedPrompt;
 
-            auto response = m_chatAPI->send_image(
-                m_base64Image,
-                type,
-                enhancedPrompt.toStdString(),
-                1500,
-                0.7,
-                [this]() { return m_cancelRequested.load(); }
-                );
+            const QByteArray cacheKey = ResponseCache::makeKey(getProvider(), type, language,
+                                                               enhancedPrompt, base64Image, 1500, 0.7);
+            if (replyFromCache(requestId, cacheKey)) return false;
+
+            if (providerEndpoint(getProvider()).supportsImages &&
+                startStream(requestId, imageMessages(enhancedPrompt, base64Image, encoded.mimeType),
+                            1500, 0.7, cacheKey, "Image API")) {
+                streaming = true;
+                return false;
+            }
+
+            auto response = timed(metrics().sendImage, [&]() {
+                return api()->send_image(
+                    base64Image.toStdString(),
+                    type,
+                    enhancedPrompt.toStdString(),
+                    1500,
+                    0.7,
+                    [this]() { return m_cancelRequested.load(); }
+                    );
+            });
 
             if (m_cancelRequested.load()) return true;
 
-            response = m_chatAPI->get_assistant_reply(response);
-            emit responseReceived(QString::fromStdString(response));
+            response = timed(metrics().assistantReply, [&]() {
+                return api()->get_assistant_reply(response);
+            });
+            const QString reply = QString::fromStdString(response);
+            storeInCache(cacheKey, reply);
+            emit responseReceived(requestId, reply, false);
             return false;
         }();
 
         if (wasCancelled) {
-            emit requestCancelled();
+            emit requestCancelled(requestId);
         }
     }
     catch (const std::exception& e) {
         if (!m_cancelRequested.load()) {
+            metrics().errors.add();
             qWarning() << "Image API error:" << e.what();
-            emit errorOccurred(QString("Image API request failed: %1").arg(e.what()));
+            emit errorOccurred(requestId, QString("Image API request failed: %1").arg(e.what()));
         }
     }
-
-    m_isBusy.store(false); // Reset busy flag
+    return streaming;
 }
 
-void ChatAPIWorker::resendImageRequest(const QString& language,
+bool ChatAPIWorker::resendImageRequest(quint64 requestId,
+                                       const QByteArray& base64Image,
+                                       const QByteArray& mimeType,
+                                       const QString& language,
                                        hyni::chat_api::QUESTION_TYPE type) {
-    if (m_base64Image.empty()) {
+    if (base64Image.isEmpty()) {
         qDebug() << "Image base64 is empty";
-        return;
-    }
-
-
-    if (m_isBusy.exchange(true)) {
-        qDebug() << "Image request ignored - worker busy";
-        return;
+        return false;
     }
 
-    if (!m_chatAPI->has_api_key()) {
+    if (!api()->has_api_key()) {
         emit needApiKey();
-        return;
+        return false;
     }
 
-    m_cancelRequested.store(false);
-
+    bool streaming = false;
     try {
+        // A lossy image from a streamed request goes to hyni as PNG again,
+        // see sendImageRequest()
+        QByteArray image = base64Image;
+        QByteArray imageMimeType = mimeType;
+        if (imageMimeType != "image/png" && !streamsImages()) {
+            ImageEncodeProfile profile = ImageEncodeProfile::forQuestionType(type);
+            profile.allowLossy = false;
+            const EncodedImage encoded = ImageEncoder::encode(QImage::fromData(QByteArray::fromBase64(base64Image)),
+                                                              profile);
+            image = encoded.base64;
+            imageMimeType = encoded.mimeType;
+        }
+
         const bool wasCancelled = [&]() {
             if (m_cancelRequested.load()) return true;
 
@@ -163,94 +558,134 @@ void ChatAPIWorker::resendImageRequest(const QString& language,
 
             qDebug() << enhancedPrompt;
 
-            auto response = m_chatAPI->send_image(
-                m_base64Image,
-                type,
-                enhancedPrompt.toStdString(),
-                2000,
-                0.8,
-                [this]() { return m_cancelRequested.load(); }
-                );
+            const QByteArray cacheKey = ResponseCache::makeKey(getProvider(), type, language,
+                                                               enhancedPrompt, image, 2000, 0.8);
+            if (replyFromCache(requestId, cacheKey)) return false;
+
+            if (providerEndpoint(getProvider()).supportsImages &&
+                startStream(requestId, imageMessages(enhancedPrompt, image, imageMimeType),
+                            2000, 0.8, cacheKey, "Image API")) {
+                streaming = true;
+                return false;
+            }
+
+            auto response = timed(metrics().sendImage, [&]() {
+                return api()->send_image(
+                    image.toStdString(),
+                    type,
+                    enhancedPrompt.toStdString(),
+                    2000,
+                    0.8,
+                    [this]() { return m_cancelRequested.load(); }
+                    );
+            });
 
             if (m_cancelRequested.load()) return true;
 
-            response = m_chatAPI->get_assistant_reply(response);
-            emit responseReceived(QString::fromStdString(response));
+            response = timed(metrics().assistantReply, [&]() {
+                return api()->get_assistant_reply(response);
+            });
+            const QString reply = QString::fromStdString(response);
+            storeInCache(cacheKey, reply);
+            emit responseReceived(requestId, reply, false);
             return false;
         }();
 
         if (wasCancelled) {
-            emit requestCancelled();
+            emit requestCancelled(requestId);
         }
     }
     catch (const std::exception& e) {
         if (!m_cancelRequested.load()) {
+            metrics().errors.add();
             qWarning() << "Image API error:" << e.what();
-            emit errorOccurred(QString("Image API request failed: %1").arg(e.what()));
+            emit errorOccurred(requestId, QString("Image API request failed: %1").arg(e.what()));
         }
     }
-
-    m_isBusy.store(false); // Reset busy flag
+    return streaming;
 }
 
 
-void ChatAPIWorker::sendRequest(const QString& message, hyni::chat_api::QUESTION_TYPE type) {
-    if (m_isBusy.exchange(true)) {
-        qDebug() << "Request ignored - worker busy";
-        return;
-    }
-
-    if (!m_chatAPI->has_api_key()) {
+bool ChatAPIWorker::sendRequest(quint64 requestId,
+                                const QString& message,
+                                hyni::chat_api::QUESTION_TYPE type) {
+    if (!api()->has_api_key()) {
         emit needApiKey();
-        return;
+        return false;
     }
 
-    m_cancelRequested.store(false);
-
+    bool streaming = false;
     try {
         const bool wasCancelled = [&]() {
             if (m_cancelRequested.load()) return true;
 
             qDebug() << message;
 
-            auto response = m_chatAPI->send_message(
-                message.toStdString(),
-                type,
-                1500,
-                0.7,
-                [this]() { return m_cancelRequested.load(); }
-                );
+            const QByteArray cacheKey = ResponseCache::makeKey(getProvider(), type, QString(),
+                                                               message, QByteArray(), 1500, 0.7);
+            if (replyFromCache(requestId, cacheKey)) return false;
+
+            if (startStream(requestId, textMessages(message), 1500, 0.7, cacheKey, "API")) {
+                streaming = true;
+                return false;
+            }
+
+            auto response = timed(metrics().sendMessage, [&]() {
+                return api()->send_message(
+                    message.toStdString(),
+                    type,
+                    1500,
+                    0.7,
+                    [this]() { return m_cancelRequested.load(); }
+                    );
+            });
 
             if (m_cancelRequested.load()) return true;
 
-            response = m_chatAPI->get_assistant_reply(response);
-            emit responseReceived(QString::fromStdString(response));
+            response = timed(metrics().assistantReply, [&]() {
+                return api()->get_assistant_reply(response);
+            });
+            const QString reply = QString::fromStdString(response);
+            storeInCache(cacheKey, reply);
+            emit responseReceived(requestId, reply, false);
             return false;
         }();
 
         if (wasCancelled) {
-            emit requestCancelled();
+            emit requestCancelled(requestId);
         }
     }
     catch (const std::exception& e) {
         if (!m_cancelRequested.load()) {
+            metrics().errors.add();
             qWarning() << "API error:" << e.what();
-            emit errorOccurred(QString("API request failed: %1").arg(e.what()));
+            emit errorOccurred(requestId, QString("API request failed: %1").arg(e.what()));
         }
     }
+    return streaming;
+}
 
-    m_isBusy.store(false); // Reset busy flag
+// Safe to call from any thread; a request that has not started yet is
+// cancelled as soon as the worker picks it up.
+void ChatAPIWorker::cancelRequest(quint64 requestId) {
+    m_cancelTargetId.store(requestId);
+    if (m_activeRequestId.load() == requestId) {
+        cancelCurrentRequest();
+    }
 }
 
 void ChatAPIWorker::cancelCurrentRequest() {
     m_cancelRequested.store(true);
-    if (m_chatAPI) {
-        m_chatAPI->cancel();
+    if (hyni::chat_api* chatAPI = api()) {
+        chatAPI->cancel();
     }
+    const quint64 requestId = m_activeRequestId.load();
+    QMetaObject::invokeMethod(this, [this, requestId]() {
+        abortStream(requestId);
+    }, Qt::QueuedConnection);
 }
 
-void ChatAPIWorker::setAPIKey(const QString& apiKey) {
-    if (m_chatAPI) {
-        m_chatAPI->set_api_key(apiKey.toStdString());
-    }
+void ChatAPIWorker::setAPIKey(hyni::chat_api::API_PROVIDER provider, const QString& apiKey) {
+    m_apiKeys[provider] = apiKey;
+    apiFor(provider)->set_api_key(apiKey.toStdString());
 }
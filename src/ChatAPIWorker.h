@@ -2,41 +2,99 @@
 #define CHATAPI_WORKER_H
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <map>
 #include <memory>
+#include <set>
 #include "chat_api.h"
+#include "ChatRequest.h"
 #include <atomic>
 
+class QNetworkAccessManager;
+class QTimer;
+class ResponseCache;
+
 class ChatAPIWorker : public QObject {
     Q_OBJECT
 
 public:
     explicit ChatAPIWorker(QObject *parent = nullptr);
     ~ChatAPIWorker();
+    // Of the request being processed, else the selected one
     hyni::chat_api::API_PROVIDER getProvider() const;
-    void setProvider(hyni::chat_api::API_PROVIDER);
+    void setStreamingEnabled(bool enabled);
+    void setResponseCache(std::shared_ptr<ResponseCache> cache);
+    void cancelRequest(quint64 requestId);
+    void cancelCurrentRequest();
 
 public slots:
-    void sendImageRequest(const QPixmap& pixmap,
-                          const QString& language,
-                          hyni::chat_api::QUESTION_TYPE type);
-    void resendImageRequest(const QString& language,
-                            hyni::chat_api::QUESTION_TYPE type);
-    void sendRequest(const QString& message,
-                     hyni::chat_api::QUESTION_TYPE type);
-    void cancelCurrentRequest();
-    void setAPIKey(const QString& apiKey);
+    void processRequest(const ChatRequest& request);
+    void setProvider(hyni::chat_api::API_PROVIDER);
+    void setAPIKey(hyni::chat_api::API_PROVIDER provider, const QString& apiKey);
+    void warmUp(hyni::chat_api::API_PROVIDER provider);
 
 signals:
-    void responseReceived(const QString& response);
-    void errorOccurred(const QString& error);
-    void requestCancelled();
+    void partialResponseReceived(quint64 requestId, const QString& delta);
+    void responseReceived(quint64 requestId, const QString& response, bool fromCache);
+    void errorOccurred(quint64 requestId, const QString& error);
+    void requestCancelled(quint64 requestId);
+    void requestFinished(quint64 requestId);
+    void imageEncoded(quint64 requestId, const QByteArray& base64Image, const QByteArray& mimeType);
     void needApiKey();
 
 private:
-    std::unique_ptr<hyni::chat_api> m_chatAPI;
-    std::atomic<bool> m_isBusy{false};
+    struct Stream;
+
+    // Each returns true when the answer streams and finishes later
+    bool sendImageRequest(quint64 requestId,
+                          const QImage& image,
+                          const QString& language,
+                          hyni::chat_api::QUESTION_TYPE type);
+    bool resendImageRequest(quint64 requestId,
+                            const QByteArray& base64Image,
+                            const QByteArray& mimeType,
+                            const QString& language,
+                            hyni::chat_api::QUESTION_TYPE type);
+    bool sendRequest(quint64 requestId,
+                     const QString& message,
+                     hyni::chat_api::QUESTION_TYPE type);
+    bool startStream(quint64 requestId,
+                     const QJsonArray& messages,
+                     int maxTokens,
+                     double temperature,
+                     const QByteArray& cacheKey,
+                     const QString& apiName);
+    void readStream();
+    void appendStreamEvent(Stream& stream, const QByteArray& data);
+    void finishStream();
+    void abortStream(quint64 requestId);
+    void finishRequest(quint64 requestId);
+    QString streamingApiKey() const;
+    bool streamsImages() const;
+    hyni::chat_api* api() const;
+    hyni::chat_api* apiFor(hyni::chat_api::API_PROVIDER provider);
+    void startKeepAlive();
+    void applyStreamingEnabled();
+    void connectAhead(hyni::chat_api::API_PROVIDER provider);
+    void keepAlive();
+    bool replyFromCache(quint64 requestId, const QByteArray& cacheKey);
+    void storeInCache(const QByteArray& cacheKey, const QString& reply);
+
+    std::map<hyni::chat_api::API_PROVIDER, std::unique_ptr<hyni::chat_api>> m_chatAPIs;
+    std::atomic<hyni::chat_api*> m_selectedAPI{nullptr};
+    std::atomic<hyni::chat_api*> m_activeAPI{nullptr};
+    std::shared_ptr<ResponseCache> m_cache;
+    QNetworkAccessManager* m_network{nullptr};
+    std::unique_ptr<Stream> m_stream;
+    std::set<hyni::chat_api::API_PROVIDER> m_warmProviders;
+    QTimer* m_keepAliveTimer{nullptr};
+    QElapsedTimer m_lastRequest;
+    std::map<hyni::chat_api::API_PROVIDER, QString> m_apiKeys;  // entered by the user
+    std::atomic<bool> m_streamingEnabled{false};
     std::atomic<bool> m_cancelRequested{false};
-    std::string m_base64Image;
+    std::atomic<quint64> m_activeRequestId{0};
+    std::atomic<quint64> m_cancelTargetId{0};
 };
 
 #endif // CHATAPI_WORKER_H
@@ -0,0 +1,33 @@
+#ifndef CHAT_REQUEST_H
+#define CHAT_REQUEST_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QMetaType>
+#include <QString>
+#include "chat_api.h"
+
+// A single unit of work for ChatAPIWorker. The id is assigned by the
+// ChatRequestScheduler and travels with every signal about the request.
+struct ChatRequest {
+    enum class Kind {
+        Text,
+        Image,
+        ResendImage
+    };
+
+    quint64 id{0};
+    Kind kind{Kind::Text};
+    hyni::chat_api::QUESTION_TYPE type{hyni::chat_api::QUESTION_TYPE::General};
+    // Unknown: whichever provider the scheduler has selected
+    hyni::chat_api::API_PROVIDER provider{hyni::chat_api::API_PROVIDER::Unknown};
+    QString message;        // Text: the complete prompt
+    QString language;       // Image/ResendImage: target programming language
+    QImage image;           // Image: screenshot to encode and send
+    QByteArray base64Image; // ResendImage: previously encoded screenshot
+    QByteArray imageMimeType;
+};
+
+Q_DECLARE_METATYPE(ChatRequest)
+
+#endif // CHAT_REQUEST_H
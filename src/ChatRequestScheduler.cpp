@@ -0,0 +1,242 @@
+#include "ChatRequestScheduler.h"
+#include "ChatAPIWorker.h"
+#include "ProviderConfig.h"
+#include "ResponseCache.h"
+#include <QDebug>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+ChatRequestScheduler::ChatRequestScheduler(int workerCount,
+                                           int queueCapacity,
+                                           QObject *parent)
+    : QObject(parent),
+    m_queueCapacity(std::max(queueCapacity, 0)) {
+    qRegisterMetaType<ChatRequest>();
+
+    m_cache = std::make_shared<ResponseCache>(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/responses");
+
+    ensureWorkerCount(std::max(workerCount, 1));
+}
+
+ChatRequestScheduler::~ChatRequestScheduler() {
+    cancelAll();
+
+    for (WorkerSlot& slot : m_slots) {
+        slot.thread->quit();
+        if (!slot.thread->wait(500)) {
+            slot.thread->terminate();
+            slot.thread->wait();
+        }
+    }
+}
+
+quint64 ChatRequestScheduler::submit(ChatRequest request) {
+    if (request.kind == ChatRequest::Kind::ResendImage && request.base64Image.isEmpty()) {
+        if (m_lastImage.isEmpty()) {
+            qDebug() << "Image base64 is empty";
+            return 0;
+        }
+        request.base64Image = m_lastImage;
+        request.imageMimeType = m_lastImageMimeType;
+    }
+
+    if (m_queue.size() >= m_queueCapacity && activeCount() == m_slots.size()) {
+        qWarning() << "Request rejected - queue full";
+        return 0;
+    }
+
+    request.id = m_nextRequestId++;
+    const quint64 requestId = request.id;
+
+    m_queue.enqueue(std::move(request));
+    dispatch();
+
+    return requestId;
+}
+
+void ChatRequestScheduler::cancel(quint64 requestId) {
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if (it->id == requestId) {
+            m_queue.erase(it);
+            emit requestCancelled(requestId);
+            emit requestFinished(requestId);
+            return;
+        }
+    }
+
+    for (WorkerSlot& slot : m_slots) {
+        if (slot.activeRequestId == requestId) {
+            slot.worker->cancelRequest(requestId);
+            return;
+        }
+    }
+}
+
+void ChatRequestScheduler::cancelAll() {
+    while (!m_queue.isEmpty()) {
+        const quint64 requestId = m_queue.dequeue().id;
+        emit requestCancelled(requestId);
+        emit requestFinished(requestId);
+    }
+
+    for (WorkerSlot& slot : m_slots) {
+        if (slot.activeRequestId != 0) {
+            slot.worker->cancelRequest(slot.activeRequestId);
+        }
+    }
+}
+
+// Grows the pool so that at least workerCount requests can run at once.
+// Workers are never removed; idle ones cost only a sleeping thread.
+void ChatRequestScheduler::ensureWorkerCount(int workerCount) {
+    while (m_slots.size() < workerCount) {
+        addWorker();
+    }
+    dispatch();
+}
+
+void ChatRequestScheduler::addWorker() {
+    const int index = m_slots.size();
+
+    WorkerSlot slot;
+    slot.thread = new QThread(this);
+    slot.worker = new ChatAPIWorker();
+    slot.worker->setStreamingEnabled(m_streamingEnabled);
+    slot.worker->setResponseCache(m_cache);
+    if (m_provider != hyni::chat_api::API_PROVIDER::OpenAI) {
+        slot.worker->setProvider(m_provider);
+    }
+    for (const auto& [provider, apiKey] : m_apiKeys) {
+        slot.worker->setAPIKey(provider, apiKey);
+    }
+    slot.worker->moveToThread(slot.thread);
+
+    connect(slot.worker, &ChatAPIWorker::partialResponseReceived,
+            this, &ChatRequestScheduler::partialResponseReceived);
+    connect(slot.worker, &ChatAPIWorker::responseReceived,
+            this, &ChatRequestScheduler::responseReceived);
+    connect(slot.worker, &ChatAPIWorker::errorOccurred,
+            this, &ChatRequestScheduler::errorOccurred);
+    connect(slot.worker, &ChatAPIWorker::requestCancelled,
+            this, &ChatRequestScheduler::requestCancelled);
+    connect(slot.worker, &ChatAPIWorker::needApiKey,
+            this, &ChatRequestScheduler::needApiKey);
+    connect(slot.worker, &ChatAPIWorker::imageEncoded,
+            this, [this](quint64, const QByteArray& base64Image, const QByteArray& mimeType) {
+                m_lastImage = base64Image;
+                m_lastImageMimeType = mimeType;
+            });
+    connect(slot.worker, &ChatAPIWorker::requestFinished,
+            this, [this, index](quint64 requestId) {
+                handleWorkerFinished(index, requestId);
+            });
+
+    connect(slot.thread, &QThread::finished, slot.worker, &QObject::deleteLater);
+
+    slot.thread->start();
+    m_slots.push_back(slot);
+
+    // Connects in the worker's thread, where its network manager lives
+    QMetaObject::invokeMethod(slot.worker, "warmUp",
+                              Qt::QueuedConnection,
+                              Q_ARG(hyni::chat_api::API_PROVIDER, m_provider));
+}
+
+hyni::chat_api::API_PROVIDER ChatRequestScheduler::provider() const {
+    return m_provider;
+}
+
+void ChatRequestScheduler::setProvider(hyni::chat_api::API_PROVIDER provider) {
+    m_provider = provider;
+    for (const WorkerSlot& slot : m_slots) {
+        QMetaObject::invokeMethod(slot.worker, "setProvider",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(hyni::chat_api::API_PROVIDER, provider));
+    }
+    warmUp(provider);
+}
+
+void ChatRequestScheduler::warmUp(hyni::chat_api::API_PROVIDER provider) {
+    for (const WorkerSlot& slot : m_slots) {
+        QMetaObject::invokeMethod(slot.worker, "warmUp",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(hyni::chat_api::API_PROVIDER, provider));
+    }
+}
+
+void ChatRequestScheduler::setAPIKey(hyni::chat_api::API_PROVIDER provider, const QString& apiKey) {
+    m_apiKeys[provider] = apiKey;
+    for (const WorkerSlot& slot : m_slots) {
+        QMetaObject::invokeMethod(slot.worker, "setAPIKey",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(hyni::chat_api::API_PROVIDER, provider),
+                                  Q_ARG(QString, apiKey));
+    }
+}
+
+QString ChatRequestScheduler::apiKey(hyni::chat_api::API_PROVIDER provider) const {
+    const auto it = m_apiKeys.find(provider);
+    if (it != m_apiKeys.end() && !it->second.isEmpty()) {
+        return it->second;
+    }
+    return qEnvironmentVariable(providerEndpoint(provider).apiKeyEnv);
+}
+
+void ChatRequestScheduler::setStreamingEnabled(bool enabled) {
+    m_streamingEnabled = enabled;
+    for (const WorkerSlot& slot : m_slots) {
+        slot.worker->setStreamingEnabled(enabled);
+    }
+}
+
+void ChatRequestScheduler::setCacheEnabled(bool enabled) {
+    m_cache->setEnabled(enabled);
+}
+
+bool ChatRequestScheduler::hasImage() const {
+    return !m_lastImage.isEmpty();
+}
+
+int ChatRequestScheduler::workerCount() const {
+    return m_slots.size();
+}
+
+int ChatRequestScheduler::activeCount() const {
+    return std::count_if(m_slots.begin(), m_slots.end(), [](const WorkerSlot& slot) {
+        return slot.activeRequestId != 0;
+    });
+}
+
+int ChatRequestScheduler::queuedCount() const {
+    return m_queue.size();
+}
+
+void ChatRequestScheduler::dispatch() {
+    for (WorkerSlot& slot : m_slots) {
+        if (m_queue.isEmpty()) {
+            return;
+        }
+        if (slot.activeRequestId != 0) {
+            continue;
+        }
+
+        ChatRequest request = m_queue.dequeue();
+        slot.activeRequestId = request.id;
+
+        QMetaObject::invokeMethod(slot.worker, "processRequest",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(ChatRequest, request));
+    }
+}
+
+void ChatRequestScheduler::handleWorkerFinished(int slotIndex, quint64 requestId) {
+    WorkerSlot& slot = m_slots[slotIndex];
+    if (slot.activeRequestId == requestId) {
+        slot.activeRequestId = 0;
+    }
+
+    emit requestFinished(requestId);
+    dispatch();
+}
@@ -0,0 +1,83 @@
+#ifndef CHAT_REQUEST_SCHEDULER_H
+#define CHAT_REQUEST_SCHEDULER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+#include <map>
+#include <memory>
+#include "ChatRequest.h"
+#include "chat_api.h"
+
+class ChatAPIWorker;
+class ResponseCache;
+class QThread;
+
+// Owns a fixed pool of ChatAPIWorkers, each on its own QThread, and hands
+// out requests from a bounded FIFO queue to whichever worker is idle.
+// Every signal carries the id returned by submit() so callers can route the
+// result back to wherever the request came from.
+class ChatRequestScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ChatRequestScheduler(int workerCount,
+                                  int queueCapacity,
+                                  QObject *parent = nullptr);
+    ~ChatRequestScheduler();
+
+    // Returns the request id, or 0 if the queue is full.
+    quint64 submit(ChatRequest request);
+    void cancel(quint64 requestId);
+    void cancelAll();
+
+    hyni::chat_api::API_PROVIDER provider() const;
+    void setProvider(hyni::chat_api::API_PROVIDER provider);
+    // Opens connections to the provider ahead of its first streamed request,
+    // once streaming is on
+    void warmUp(hyni::chat_api::API_PROVIDER provider);
+    // Keys belong to one provider and are never sent to another
+    void setAPIKey(hyni::chat_api::API_PROVIDER provider, const QString& apiKey);
+    // The key entered for the provider, else its environment variable
+    QString apiKey(hyni::chat_api::API_PROVIDER provider) const;
+    void setStreamingEnabled(bool enabled);
+    void setCacheEnabled(bool enabled);
+
+    bool hasImage() const;
+    void ensureWorkerCount(int workerCount);
+    int workerCount() const;
+    int activeCount() const;
+    int queuedCount() const;
+
+signals:
+    void partialResponseReceived(quint64 requestId, const QString& delta);
+    void responseReceived(quint64 requestId, const QString& response, bool fromCache);
+    void errorOccurred(quint64 requestId, const QString& error);
+    void requestCancelled(quint64 requestId);
+    void requestFinished(quint64 requestId);
+    void needApiKey();
+
+private:
+    struct WorkerSlot {
+        QThread* thread{nullptr};
+        ChatAPIWorker* worker{nullptr};
+        quint64 activeRequestId{0};
+    };
+
+    void addWorker();
+    void dispatch();
+    void handleWorkerFinished(int slotIndex, quint64 requestId);
+
+    std::shared_ptr<ResponseCache> m_cache;
+    QVector<WorkerSlot> m_slots;
+    QQueue<ChatRequest> m_queue;
+    int m_queueCapacity;
+    quint64 m_nextRequestId{1};
+    hyni::chat_api::API_PROVIDER m_provider{hyni::chat_api::API_PROVIDER::OpenAI};
+    std::map<hyni::chat_api::API_PROVIDER, QString> m_apiKeys;
+    bool m_streamingEnabled{false};
+    QByteArray m_lastImage;
+    QByteArray m_lastImageMimeType;
+};
+
+#endif // CHAT_REQUEST_SCHEDULER_H
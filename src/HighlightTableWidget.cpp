@@ -1,7 +1,8 @@
 #include "HighlightTableWidget.h"
-#include "response_utils.h"
 #include <QHeaderView>
-#include <QDebug>
+#include <QElapsedTimer>
+#include <QScreen>
+#include <utility>
 #include <qevent.h>
 
 
@@ -22,62 +23,177 @@ HighlightTableWidget::HighlightTableWidget(QWidget* parent) : QTableWidget(paren
 
     // Enable word wrapping for the table
     setWordWrap(true);
+
+    m_updateTimer.setSingleShot(true);
+    connect(&m_updateTimer, &QTimer::timeout, this, &HighlightTableWidget::applyPendingText);
+
+    // Keep the index in step with rows removed behind our back
+    connect(model(), &QAbstractItemModel::rowsRemoved, this, [this]() {
+        if (m_index.rowCount() != rowCount()) {
+            rebuildIndex();
+        }
+    });
 }
 
 void HighlightTableWidget::highlightText(const QString& text) {
-    QString highlightedText;
+    // Transcripts are often slightly off, so settle for similar rows
+    QList<int> matches = findRows(text);
+    if (matches.isEmpty()) {
+        matches = findRows(text, true);
+    }
 
-    // Iterate through all cells in the table
-    for (int row = 0; row < rowCount(); ++row) {
-        QTableWidgetItem* item = this->item(row, 0); // Only one column
-        if (item && item->text().contains(text)) {
-            // Highlight the cell
-            item->setBackground(Qt::yellow);
-            highlightedText = item->text(); // Store the highlighted text
-            break; // Stop after finding the first match
-        } else if (item) {
-            // Remove highlighting
-            item->setBackground(Qt::white);
+    // Only touch rows whose highlight changes; every setBackground repaints
+    const QSet<int> highlighted(matches.cbegin(), matches.cend());
+    for (int row : std::as_const(m_highlightedRows)) {
+        if (!highlighted.contains(row)) {
+            if (QTableWidgetItem* item = this->item(row, 0)) {
+                item->setBackground(QBrush());
+            }
         }
     }
+    for (int row : highlighted) {
+        if (!m_highlightedRows.contains(row)) {
+            if (QTableWidgetItem* item = this->item(row, 0)) {
+                item->setBackground(Qt::yellow);
+            }
+        }
+    }
+    m_highlightedRows = highlighted;
 
-    // Emit the highlighted text (single line)
-    if (!highlightedText.isEmpty()) {
-        emit textHighlighted(highlightedText);
+    // Emit the best match (single line)
+    if (!matches.isEmpty()) {
+        if (QTableWidgetItem* item = this->item(matches.first(), 0)) {
+            emit textHighlighted(item->text());
+        }
     }
 }
 
+QList<int> HighlightTableWidget::findRows(const QString& text, bool fuzzy) const {
+    return fuzzy ? m_index.findFuzzy(text) : m_index.find(text);
+}
+
+void HighlightTableWidget::setUpdateInterval(int intervalMs) {
+    m_updateIntervalMs = qMax(FRAME_INTERVAL, intervalMs);
+}
+
+int HighlightTableWidget::updateInterval() const {
+    return m_updateIntervalMs;
+}
+
+HighlightTableWidget::UpdateStats HighlightTableWidget::updateStats() const {
+    return m_updateStats;
+}
+
+void HighlightTableWidget::rebuildIndex() {
+    m_updateTimer.stop();
+    m_pendingFragments = 0;
+    m_transcript.clear();  // seeded again from the last row
+    m_index.clear();
+    for (int row = 0; row < rowCount(); ++row) {
+        const QTableWidgetItem* item = this->item(row, 0);
+        m_index.setRow(row, item ? item->text() : QString());
+    }
+
+    QSet<int> stillHighlighted;
+    for (int row : std::as_const(m_highlightedRows)) {
+        if (row < rowCount()) {
+            stillHighlighted.insert(row);
+        }
+    }
+    m_highlightedRows = stillHighlighted;
+}
+
 void HighlightTableWidget::clearRow() {
+    m_updateTimer.stop();
+    m_pendingFragments = 0;
     setRowCount(0);
+    m_transcript.clear();
+    m_index.clear();
+    m_highlightedRows.clear();
+    emit lastRowChanged(QString());
 }
 
-void HighlightTableWidget::addText(const QString& text) {
+void HighlightTableWidget::queueText(const QString& text) {
 
     if (text.isEmpty()) return;
 
-    const QString base = getLastRowString();
+    QTableWidgetItem *last = rowCount() > 0 ? item(rowCount() - 1, 0) : nullptr;
+    if (!last || last->text().isEmpty()) {
+        addText(text);
+        return;
+    }
 
-    if (!base.isEmpty()) {
-        int matchIndex;
-        std::string mergedText = hyni::response_utils::merge_strings(base.toStdString(),
-                                                                     text.toStdString(),
-                                                                     matchIndex);
+    // The text and the index are updated right away, both are cheap
+    if (m_transcript.isEmpty()) {
+        m_transcript.setText(last->text());
+    }
+    const qsizetype previousSize = m_transcript.text().size();
+    m_transcript.append(text);
+    m_index.appendToRow(rowCount() - 1, QStringView(m_transcript.text()).mid(previousSize));
+
+    ++m_pendingFragments;
+    ++m_updateStats.fragments;
+    emit lastRowChanged(m_transcript.text());
+
+    if (!m_updateTimer.isActive()) {
+        int intervalMs = m_updateIntervalMs;
+        if (intervalMs == FRAME_INTERVAL) {
+            const qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+            intervalMs = qMax(1, qRound(1000.0 / (refreshRate > 0 ? refreshRate : 60.0)));
+        }
+        m_updateTimer.start(intervalMs);
+    }
+}
+
+void HighlightTableWidget::applyPendingText() {
 
-        qDebug() << "match index: " << matchIndex;
-        QTableWidgetItem *obj = item(rowCount() - 1, 0);
-        if (obj) {
-            obj->setText(QString::fromStdString(mergedText));
-            resizeRowToContents(rowCount() - 1);
+    m_updateTimer.stop();
+    if (m_pendingFragments == 0) return;
+
+    QTableWidgetItem *last = rowCount() > 0 ? item(rowCount() - 1, 0) : nullptr;
+    if (last) {
+        QElapsedTimer timer;
+        timer.start();
+        last->setText(m_transcript.text());
+        resizeRowToContents(rowCount() - 1);
+        m_updateStats.layoutNs += timer.nsecsElapsed();
+    }
+
+    ++m_updateStats.batches;
+    m_updateStats.coalesced += m_pendingFragments - 1;
+    m_pendingFragments = 0;
+}
+
+void HighlightTableWidget::addText(const QString& text) {
+
+    if (text.isEmpty()) return;
+
+    // Keep the order of text queued before
+    applyPendingText();
+
+    QTableWidgetItem *last = rowCount() > 0 ? item(rowCount() - 1, 0) : nullptr;
+    if (last && !last->text().isEmpty()) {
+        if (m_transcript.isEmpty()) {
+            m_transcript.setText(last->text());
         }
+        const qsizetype previousSize = m_transcript.text().size();
+        m_transcript.append(text);
+
+        m_index.appendToRow(rowCount() - 1, QStringView(m_transcript.text()).mid(previousSize));
+        last->setText(m_transcript.text());
+        resizeRowToContents(rowCount() - 1);
+        emit lastRowChanged(m_transcript.text());
         return;
     }
 
+    m_transcript.setText(text);
+
     // Add a new row to the table
     int row = rowCount();
     insertRow(row);
 
     // Add the text to the first column of the new row
-    QTableWidgetItem* item = new QTableWidgetItem(text);
+    QTableWidgetItem* item = new QTableWidgetItem(m_transcript.text());
 
     // Enable text wrapping
     item->setTextAlignment(Qt::AlignLeft | Qt::AlignTop); // Align text to the top-left
@@ -86,9 +202,11 @@ void HighlightTableWidget::addText(const QString& text) {
     item->setData(Qt::TextWordWrap, true); // Enable word wrapping
 
     setItem(row, 0, item);
+    m_index.setRow(row, m_transcript.text());
 
     // Adjust row height to fit wrapped text
     resizeRowToContents(row);
+    emit lastRowChanged(m_transcript.text());
 }
 
 QString HighlightTableWidget::getLastRowString() const {
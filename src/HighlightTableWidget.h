@@ -3,25 +3,76 @@
 
 #include <QTableWidget>
 #include <QTableWidgetItem>
+#include <QSet>
+#include <QTimer>
+#include "TranscriptBuffer.h"
+#include "TranscriptIndex.h"
 
 class HighlightTableWidget : public QTableWidget {
     Q_OBJECT
 
 public:
+    // Batching of queueText() updates
+    struct UpdateStats {
+        quint64 fragments{0};  // queued through queueText()
+        quint64 batches{0};    // row layouts done for them
+        quint64 coalesced{0};  // row layouts saved by batching
+        qint64 layoutNs{0};    // spent in setText() and resizeRowToContents()
+
+        // What the saved layouts would have cost at the average batch cost
+        qint64 savedNs() const {
+            return batches ? qint64(coalesced) * (layoutNs / qint64(batches)) : 0;
+        }
+    };
+
+    // Apply queued text once per display frame
+    static constexpr int FRAME_INTERVAL = 0;
+
     explicit HighlightTableWidget(QWidget* parent = nullptr);
     QString getLastRowString() const;
     QString getLastRowString();
 
+    // Rows containing text, ignoring case, or when fuzzy the rows most
+    // similar to it, best first.
+    QList<int> findRows(const QString& text, bool fuzzy = false) const;
+
+    // How long queueText() waits before laying out the row, in ms or
+    // FRAME_INTERVAL.
+    void setUpdateInterval(int intervalMs);
+    int updateInterval() const;
+    UpdateStats updateStats() const;
+
 signals:
     void textHighlighted(const QString& text);
+    // The text getLastRowString() returns changed; empty once cleared
+    void lastRowChanged(const QString& text);
 
 public slots:
     void highlightText(const QString& text);
     void addText(const QString& text);
+    // Like addText(), but the expensive relayout of the row is deferred
+    // and done once for all text queued in the meantime.
+    void queueText(const QString& text);
+    void applyPendingText();
     void clearRow();
 
 private:
+    void rebuildIndex();
+
+    // Text of the last row, which incoming transcript fragments extend
+    TranscriptBuffer m_transcript;
+    TranscriptIndex m_index;
+    QSet<int> m_highlightedRows;
+
+    QTimer m_updateTimer;
+    int m_updateIntervalMs{FRAME_INTERVAL};
+    quint64 m_pendingFragments{0};  // in m_transcript but not yet shown
+    UpdateStats m_updateStats;
+
     QString getLastRowStringImpl() const {
+        if (m_pendingFragments > 0) {
+            return m_transcript.text();
+        }
         if (rowCount() > 0) {
             QTableWidgetItem *obj = item(rowCount() - 1, 0);
             if (obj) {
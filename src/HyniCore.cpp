@@ -0,0 +1,859 @@
+#include "HyniCore.h"
+#include "ChatRequestScheduler.h"
+#include "Metrics.h"
+#include "PngMonitor.h"
+#include "ProviderConfig.h"
+#include "config.h"
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <future>
+
+namespace {
+struct CoreMetrics {
+    LatencyHistogram& pngPickup = MetricsRegistry::global().histogram(
+        "qhyni_png_pickup_seconds", "Watched screenshot found until it is submitted");
+    LatencyHistogram& firstToken = MetricsRegistry::global().histogram(
+        "qhyni_answer_first_token_seconds", "Question submitted until the first streamed text");
+    LatencyHistogram& answer = MetricsRegistry::global().histogram(
+        "qhyni_answer_seconds", "Question submitted until the complete answer");
+    LatencyHistogram& audioFrame = MetricsRegistry::global().histogram(
+        "qhyni_audio_frame_seconds", "Voice detection and queueing of one captured audio frame");
+    MetricCounter& dropped = MetricsRegistry::global().counter(
+        "qhyni_requests_dropped_total", "Questions dropped because too many were in flight");
+    MetricCounter& speculationHits = MetricsRegistry::global().counter(
+        "qhyni_speculation_hits_total", "Speculatively sent questions that were then asked");
+    MetricCounter& speculationWasted = MetricsRegistry::global().counter(
+        "qhyni_speculation_wasted_total", "Speculatively sent questions cancelled or never asked");
+    LatencyHistogram& speculationSaved = MetricsRegistry::global().histogram(
+        "qhyni_speculation_saved_seconds", "Head start of a speculatively sent question when it was asked");
+    MetricCounter& hedgeFired = MetricsRegistry::global().counter(
+        "qhyni_hedge_fired_total", "Text questions also sent to the other provider");
+    MetricCounter& hedgeWon = MetricsRegistry::global().counter(
+        "qhyni_hedge_won_total", "Hedged questions the other provider answered first");
+};
+
+CoreMetrics& metrics() {
+    static CoreMetrics metrics;
+    return metrics;
+}
+
+int providerIndex(hyni::chat_api::API_PROVIDER provider) {
+    return provider == hyni::chat_api::API_PROVIDER::DeepSeek ? 1 : 0;
+}
+}
+
+HyniCore::HyniCore(const Options& options, QObject *parent)
+    : QObject(parent),
+    m_options(options),
+    m_ioContext(std::make_unique<boost::asio::io_context>())
+{
+    if (std::char_traits<char>::length(hyni::DEFAULT_PROG_LANGUAGE) != 0) {
+        m_languages.append(QString::fromStdString(hyni::DEFAULT_PROG_LANGUAGE));
+    } else {
+        m_languages.append("Python");
+    }
+
+    m_scheduler = new ChatRequestScheduler(m_options.workerCount, m_options.queueCapacity, this);
+
+    connect(m_scheduler, &ChatRequestScheduler::partialResponseReceived,
+            this, &HyniCore::onPartialResponse);
+    connect(m_scheduler, &ChatRequestScheduler::responseReceived,
+            this, &HyniCore::onResponse);
+    connect(m_scheduler, &ChatRequestScheduler::errorOccurred,
+            this, &HyniCore::onError);
+    connect(m_scheduler, &ChatRequestScheduler::requestFinished,
+            this, &HyniCore::onRequestFinished);
+    connect(m_scheduler, &ChatRequestScheduler::needApiKey,
+            this, &HyniCore::onNeedAPIKey);
+
+    m_utteranceEnd = new UtteranceEndDetector(this);
+    connect(m_utteranceEnd, &UtteranceEndDetector::utteranceEnded,
+            this, &HyniCore::onUtteranceEnded);
+
+    if (!m_options.watchFolder.isEmpty()) {
+        m_pngMonitor = new PngMonitor(m_options.watchFolder, this);
+        connect(m_pngMonitor, &PngMonitor::sendImage, this, &HyniCore::onWatchedImage);
+    }
+
+    if (!m_options.transcription) {
+        return;
+    }
+
+    const QString port = m_options.transcriptionPort.isEmpty() ? defaultTranscriptionPort()
+                                                               : m_options.transcriptionPort;
+    m_transcription = std::make_shared<TranscriptionClient>(
+        *m_ioContext, m_options.transcriptionHost.toStdString(), port.toStdString());
+
+    // Parsed on the io thread; one queued call drains everything that
+    // arrived since the last one.
+    m_transcription->setMessagesReadyHandler([this]() {
+        QMetaObject::invokeMethod(this, &HyniCore::onMessagesReceived, Qt::QueuedConnection);
+    });
+    m_transcription->setConnectionHandler([this](bool connected) {
+        QMetaObject::invokeMethod(this, [this, connected]() {
+            emit transcriptionConnected(connected);
+        });
+    });
+    m_transcription->setErrorHandler([this](const std::string& error) {
+        QMetaObject::invokeMethod(this, [this, error]() {
+            emit transcriptionError(QString::fromStdString(error));
+        });
+    });
+
+#ifdef ENABLE_AUDIO_STREAM
+    if (m_options.captureAudio) {
+        // Capture runs on its own high-priority thread and hands frames
+        // straight to the websocket io thread, bypassing the event loop.
+        m_audioThread = new QThread(this);
+        m_streamer = new AudioStreamer();
+        m_vad.setSampleRate(m_streamer->sampleRate());
+
+        m_streamer->setFramesReadyHandler([this]() {
+            boost::asio::post(*m_ioContext, [this]() {
+                receiveAudioData();
+            });
+        });
+        // Already on the io thread; resumes draining after the send queue
+        // made capture wait.
+        m_transcription->setAudioSpaceHandler([this]() {
+            receiveAudioData();
+        });
+        m_streamer->moveToThread(m_audioThread);
+        connect(m_audioThread, &QThread::finished, m_streamer, &QObject::deleteLater);
+    }
+#endif
+}
+
+HyniCore::~HyniCore() {
+    stopTransport();
+
+    delete m_scheduler;
+    m_scheduler = nullptr;
+}
+
+QString HyniCore::defaultTranscriptionPort() {
+#ifdef ENABLE_AUDIO_STREAM
+    return "8765";
+#else
+    return "8080";
+#endif
+}
+
+void HyniCore::start() {
+    if (!m_transcription || m_ioThread.joinable()) {
+        return;
+    }
+
+    m_ioThread = std::thread([this]() {
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard(m_ioContext->get_executor());
+        m_ioContext->run();
+    });
+
+    // The client keeps reconnecting on its own from here on
+    m_transcription->connect();
+
+#ifdef ENABLE_AUDIO_STREAM
+    if (m_streamer) {
+        m_audioThread->start(QThread::TimeCriticalPriority);
+        QMetaObject::invokeMethod(m_streamer, &AudioStreamer::startRecording, Qt::QueuedConnection);
+    }
+#endif
+}
+
+void HyniCore::stopTransport() {
+    // First, so write completions no longer call the audio-space handler
+    if (m_transcription) {
+        m_transcription->shutdown();
+    }
+
+#ifdef ENABLE_AUDIO_STREAM
+    if (m_streamer && m_audioThread->isRunning()) {
+        QMetaObject::invokeMethod(m_streamer, &AudioStreamer::stopRecording, Qt::BlockingQueuedConnection);
+
+        // Drains already posted to the io thread run before this and the
+        // ones after it do nothing, so the streamer can go away once it ran.
+        // Not bounded: the io thread is running and its handlers don't block.
+        auto drained = std::make_shared<std::promise<void>>();
+        boost::asio::post(*m_ioContext, [this, drained]() {
+            m_audioStopped = true;
+            m_transcription->setAudioSpaceHandler({});
+            drained->set_value();
+        });
+        drained->get_future().wait();
+
+        m_audioThread->quit();
+        m_audioThread->wait();
+    } else {
+        // Never started, so never handed to deleteLater
+        delete m_streamer;
+    }
+    m_streamer = nullptr;
+#endif
+    m_transcription.reset();
+
+    if (m_ioContext) {
+        // run() returns once the running handler is done. Joined, never
+        // detached: the handlers capture this.
+        m_ioContext->stop();
+        if (m_ioThread.joinable()) {
+            m_ioThread.join();
+        }
+    }
+}
+
+void HyniCore::setQuestionType(hyni::chat_api::QUESTION_TYPE type) {
+    m_questionType = type;
+}
+
+void HyniCore::setLanguages(const QStringList& languages) {
+    if (!languages.isEmpty()) {
+        m_languages = languages;
+    }
+}
+
+hyni::chat_api::API_PROVIDER HyniCore::provider() const {
+    return m_scheduler->provider();
+}
+
+void HyniCore::setProvider(hyni::chat_api::API_PROVIDER provider) {
+    if (m_scheduler->provider() != provider) {
+        m_scheduler->setProvider(provider);
+        if (canHedge()) {
+            m_scheduler->warmUp(hedgeProvider());
+        }
+    }
+}
+
+bool HyniCore::supportsImages() const {
+    return m_scheduler->provider() != hyni::chat_api::API_PROVIDER::DeepSeek;
+}
+
+bool HyniCore::hasImage() const {
+    return m_scheduler->hasImage();
+}
+
+void HyniCore::setAPIKey(const QString& apiKey) {
+    if (!apiKey.isEmpty()) {
+        m_scheduler->setAPIKey(provider(), apiKey);
+    }
+}
+
+void HyniCore::setStreamingEnabled(bool enabled) {
+    m_scheduler->setStreamingEnabled(enabled);
+}
+
+void HyniCore::setCacheEnabled(bool enabled) {
+    m_scheduler->setCacheEnabled(enabled);
+}
+
+void HyniCore::cancelAll() {
+    discardSpeculation();
+    m_scheduler->cancelAll();
+}
+
+void HyniCore::setSpeculationEnabled(bool enabled) {
+    m_speculationEnabled = enabled;
+    if (!enabled) {
+        m_utteranceEnd->reset();
+        discardSpeculation();
+    }
+}
+
+void HyniCore::setUtteranceEndConfig(const UtteranceEndConfig& config) {
+    m_utteranceEnd->setConfig(config);
+}
+
+void HyniCore::updateUtterance(const QString& text) {
+    if (!m_speculationEnabled) {
+        return;
+    }
+
+    // Cleared text is usually a Send about to claim the answer
+    if (!text.isEmpty() && !m_speculation.submissions.isEmpty() && !speculationMatches(text)) {
+        discardSpeculation();
+    }
+    m_utteranceEnd->update(text);
+}
+
+QVector<HyniCore::Submission> HyniCore::askText(const QString& text) {
+    if (text.isEmpty()) {
+        return {};
+    }
+
+    if (!m_speculation.submissions.isEmpty()) {
+        if (speculationMatches(text)) {
+            return claimSpeculation();
+        }
+        discardSpeculation();
+    }
+    if (m_speculationEnabled) {
+        ++m_speculationStats.misses;
+    }
+
+    return submitForLanguages(textRequest(text));
+}
+
+ChatRequest HyniCore::textRequest(const QString& text) const {
+    ChatRequest request;
+    request.kind = ChatRequest::Kind::Text;
+    request.type = m_questionType;
+    request.message = text;
+
+    if (request.type == hyni::chat_api::QUESTION_TYPE::Coding) {
+        // Language-specific responses, filled in per language
+        request.message += hyni::CODING_EXT;
+    } else if (request.type == hyni::chat_api::QUESTION_TYPE::SystemDesign) {
+        request.message += hyni::SYSTEM_DESIGN_EXT;
+    }
+    return request;
+}
+
+void HyniCore::onUtteranceEnded(const QString& text) {
+    if (!m_speculationEnabled || text.isEmpty()) {
+        return;
+    }
+    if (!m_speculation.submissions.isEmpty()) {
+        if (speculationMatches(text)) {
+            return;
+        }
+        discardSpeculation();
+    }
+
+    const QVector<Submission> submissions = submitForLanguages(textRequest(text), true);
+    const bool dropped = std::any_of(submissions.cbegin(), submissions.cend(),
+                                     [](const Submission& submission) { return submission.requestId == 0; });
+    if (dropped) {
+        // Not worth crowding out questions that are actually asked
+        for (const Submission& submission : submissions) {
+            if (submission.requestId != 0) {
+                HeldResponse held;
+                held.discarded = true;
+                m_held.insert(submission.requestId, held);
+                cancelRequest(submission.requestId);
+            }
+        }
+        return;
+    }
+
+    m_speculation = Speculation();
+    m_speculation.question = text.simplified();
+    m_speculation.type = m_questionType;
+    m_speculation.languages = m_languages;
+    m_speculation.provider = provider();
+    m_speculation.submissions = submissions;
+    m_speculation.unanswered = submissions.size();
+    m_speculation.dispatched.start();
+    for (const Submission& submission : submissions) {
+        m_held.insert(submission.requestId, HeldResponse{});
+    }
+    ++m_speculationStats.dispatched;
+    qDebug() << "Speculatively asked:" << m_speculation.question;
+}
+
+bool HyniCore::isSpeculative(quint64 requestId) const {
+    return std::any_of(m_speculation.submissions.cbegin(), m_speculation.submissions.cend(),
+                       [requestId](const Submission& submission) { return submission.requestId == requestId; });
+}
+
+bool HyniCore::speculationMatches(const QString& text) const {
+    return m_speculation.question == text.simplified() &&
+           m_speculation.type == m_questionType &&
+           m_speculation.languages == m_languages &&
+           m_speculation.provider == provider();
+}
+
+// Hands the held requests over as if they had just been submitted; what
+// arrived for them so far follows once the caller tracked the ids.
+QVector<HyniCore::Submission> HyniCore::claimSpeculation() {
+    const qint64 savedNs = m_speculation.answeredNs >= 0 ? m_speculation.answeredNs
+                                                         : m_speculation.dispatched.nsecsElapsed();
+    ++m_speculationStats.hits;
+    m_speculationStats.savedNs += savedNs;
+    metrics().speculationHits.add();
+    metrics().speculationSaved.record(std::chrono::nanoseconds(savedNs));
+
+    const QVector<Submission> submissions = m_speculation.submissions;
+    m_speculation = Speculation();
+    QMetaObject::invokeMethod(this, [this, submissions]() {
+        replayHeld(submissions);
+    }, Qt::QueuedConnection);
+    return submissions;
+}
+
+void HyniCore::discardSpeculation() {
+    if (m_speculation.submissions.isEmpty()) {
+        return;
+    }
+
+    const QVector<Submission> submissions = m_speculation.submissions;
+    m_speculation = Speculation();
+    ++m_speculationStats.wasted;
+    metrics().speculationWasted.add();
+
+    // Marked first: cancelling a queued request finishes it right away
+    for (const Submission& submission : submissions) {
+        auto it = m_held.find(submission.requestId);
+        if (it == m_held.end()) {
+            continue;
+        }
+        if (it->finished) {
+            m_held.erase(it);
+        } else {
+            it->discarded = true;
+        }
+    }
+    for (const Submission& submission : submissions) {
+        if (m_held.contains(submission.requestId)) {
+            cancelRequest(submission.requestId);
+        }
+    }
+}
+
+void HyniCore::replayHeld(const QVector<Submission>& submissions) {
+    for (const Submission& submission : submissions) {
+        const HeldResponse held = m_held.take(submission.requestId);
+        if (!held.streamed.isEmpty()) {
+            emit partialResponseReceived(submission.requestId, held.streamed);
+        }
+        if (held.answered) {
+            emit responseReceived(submission.requestId, held.response, held.fromCache);
+        }
+        if (held.finished) {
+            emit requestFinished(submission.requestId);
+        }
+    }
+}
+
+QVector<HyniCore::Submission> HyniCore::askImage(const QImage& image) {
+    if (!supportsImages()) {
+        emit warning("Image is not supported in the selected provider.");
+        return {};
+    }
+
+    ChatRequest request;
+    request.kind = ChatRequest::Kind::Image;
+    request.type = m_questionType;
+    request.image = image;
+
+    return submitForLanguages(std::move(request));
+}
+
+QVector<HyniCore::Submission> HyniCore::resendImage() {
+    if (!supportsImages()) {
+        emit warning("Image is not supported in the selected provider.");
+        return {};
+    }
+    if (!m_scheduler->hasImage()) {
+        emit warning("No screenshot to resend.");
+        return {};
+    }
+
+    ChatRequest request;
+    request.kind = ChatRequest::Kind::ResendImage;
+    request.type = m_questionType;
+
+    return submitForLanguages(std::move(request));
+}
+
+QVector<HyniCore::Submission> HyniCore::submitForLanguages(ChatRequest request, bool speculative) {
+    if (request.type != hyni::chat_api::QUESTION_TYPE::Coding) {
+        request.language = m_languages.first();
+        const QString language = request.language;
+        return { {language, submit(std::move(request), speculative)} };
+    }
+
+    // Coding questions fan out to one request per language, all running
+    // concurrently. Text requests carry a %1 placeholder for the language.
+    m_scheduler->ensureWorkerCount(m_languages.size());
+
+    QVector<Submission> submissions;
+    for (const QString& language : m_languages) {
+        ChatRequest languageRequest = request;
+        languageRequest.language = language;
+        if (languageRequest.kind == ChatRequest::Kind::Text) {
+            languageRequest.message = request.message.arg(language);
+        }
+        submissions.append({language, submit(std::move(languageRequest), speculative)});
+    }
+    return submissions;
+}
+
+quint64 HyniCore::submit(ChatRequest request, bool speculative) {
+    // Speculations are often thrown away; hedging them would double that
+    const bool hedged = request.kind == ChatRequest::Kind::Text && !speculative && canHedge();
+    Hedge hedge;
+    if (hedged) {
+        hedge.request = request;
+        hedge.request.provider = hedgeProvider();
+    }
+
+    const quint64 requestId = m_scheduler->submit(std::move(request));
+    if (requestId == 0) {
+        metrics().dropped.add();
+        return 0;
+    }
+
+    InFlight inFlight;
+    inFlight.provider = provider();
+    inFlight.submitted.start();
+    m_inFlight.insert(requestId, inFlight);
+
+    if (hedged) {
+        hedge.timer = new QTimer(this);
+        hedge.timer->setSingleShot(true);
+        connect(hedge.timer, &QTimer::timeout, this, [this, requestId]() {
+            fireHedge(requestId);
+        });
+        hedge.timer->start(hedgeDelayMs());
+        m_hedges.insert(requestId, hedge);
+        ++m_hedgeStats.watched;
+    }
+    return requestId;
+}
+
+// Takes the hedge along, so no half of it is left running
+void HyniCore::cancelRequest(quint64 requestId) {
+    const quint64 hedgeId = m_hedges.value(requestId).hedgeId;
+    m_scheduler->cancel(requestId);
+    if (hedgeId != 0) {
+        m_scheduler->cancel(hedgeId);
+    }
+}
+
+void HyniCore::setHedgingEnabled(bool enabled) {
+    m_hedgingEnabled = enabled;
+    if (enabled && !canHedge()) {
+        emit warning(QString("Hedging needs an API key in %1")
+                         .arg(providerEndpoint(hedgeProvider()).apiKeyEnv));
+    } else if (canHedge()) {
+        m_scheduler->warmUp(hedgeProvider());
+    }
+}
+
+void HyniCore::setHedgeConfig(const HedgeConfig& config) {
+    m_hedgeConfig = config;
+}
+
+hyni::chat_api::API_PROVIDER HyniCore::hedgeProvider() const {
+    return provider() == hyni::chat_api::API_PROVIDER::DeepSeek ? hyni::chat_api::API_PROVIDER::OpenAI
+                                                                : hyni::chat_api::API_PROVIDER::DeepSeek;
+}
+
+bool HyniCore::canHedge() const {
+    return m_hedgingEnabled && !m_scheduler->apiKey(hedgeProvider()).isEmpty();
+}
+
+int HyniCore::hedgeDelayMs() const {
+    const LatencyHistogram::Snapshot snapshot = m_firstByte[providerIndex(provider())].snapshot();
+    if (snapshot.count < std::uint64_t(std::max(m_hedgeConfig.minSamples, 1))) {
+        return m_hedgeConfig.initialDelayMs;
+    }
+    const double percentile = std::clamp(m_hedgeConfig.percentile, 0.0, 1.0);
+    return std::max(m_hedgeConfig.minDelayMs, int(snapshot.quantile(percentile) / 1000000));
+}
+
+void HyniCore::fireHedge(quint64 requestId) {
+    auto it = m_hedges.find(requestId);
+    if (it == m_hedges.end() || it->winnerId != 0 || it->hedgeId != 0 ||
+        it->primaryFailed || it->primaryFinished) {
+        return;
+    }
+
+    const hyni::chat_api::API_PROVIDER target = it->request.provider;
+    const quint64 hedgeId = m_scheduler->submit(it->request);
+    if (hedgeId == 0) {
+        return;  // the pool is busy, the first request carries on alone
+    }
+
+    it = m_hedges.find(requestId);
+    it->hedgeId = hedgeId;
+    m_hedgePrimaries.insert(hedgeId, requestId);
+
+    InFlight inFlight;
+    inFlight.provider = target;
+    inFlight.submitted.start();
+    m_inFlight.insert(hedgeId, inFlight);
+
+    ++m_hedgeStats.fired;
+    metrics().hedgeFired.add();
+    qDebug() << "Request" << requestId << "hedged as" << hedgeId;
+}
+
+// Events of a hedged request are reported under the caller's id. The first
+// of the two to stream or answer wins and the other is cancelled; false
+// for events of the loser.
+bool HyniCore::routeHedged(quint64& requestId) {
+    const quint64 primaryId = m_hedgePrimaries.value(requestId, requestId);
+    auto it = m_hedges.find(primaryId);
+    if (it == m_hedges.end()) {
+        return true;
+    }
+
+    if (it->winnerId == 0) {
+        it->winnerId = requestId;
+        if (it->timer) {
+            it->timer->stop();
+        }
+
+        const quint64 loserId = requestId == primaryId ? it->hedgeId : primaryId;
+        if (loserId != 0) {
+            if (requestId == primaryId) {
+                ++m_hedgeStats.primaryWins;
+            } else {
+                ++m_hedgeStats.hedgeWins;
+                metrics().hedgeWon.add();
+            }
+            // May finish the loser right away; it is no longer reported
+            m_scheduler->cancel(loserId);
+        }
+    } else if (it->winnerId != requestId) {
+        return false;
+    }
+
+    requestId = primaryId;
+    return true;
+}
+
+// A failure is only reported once the other request can't answer either
+bool HyniCore::routeHedgedError(quint64& requestId) {
+    const quint64 primaryId = m_hedgePrimaries.value(requestId, requestId);
+    auto it = m_hedges.find(primaryId);
+    if (it == m_hedges.end()) {
+        return true;
+    }
+    if (it->winnerId != 0) {
+        if (it->winnerId != requestId) {
+            return false;
+        }
+        requestId = primaryId;
+        return true;
+    }
+
+    bool otherRunning;
+    if (requestId == primaryId) {
+        it->primaryFailed = true;
+        if (it->timer) {
+            it->timer->stop();
+        }
+        otherRunning = it->hedgeId != 0 && !it->hedgeFailed && !it->hedgeFinished;
+    } else {
+        it->hedgeFailed = true;
+        otherRunning = !it->primaryFailed && !it->primaryFinished;
+    }
+    if (otherRunning) {
+        return false;
+    }
+
+    requestId = primaryId;
+    return true;
+}
+
+// requestFinished comes with the winner, or with the last of the two when
+// neither answered. The pair is forgotten once both finished.
+bool HyniCore::routeHedgedFinished(quint64& requestId) {
+    const quint64 primaryId = m_hedgePrimaries.value(requestId, requestId);
+    auto it = m_hedges.find(primaryId);
+    if (it == m_hedges.end()) {
+        return true;
+    }
+
+    if (requestId == primaryId) {
+        it->primaryFinished = true;
+        if (it->timer) {
+            it->timer->stop();
+        }
+    } else {
+        it->hedgeFinished = true;
+        m_inFlight.remove(requestId);
+    }
+
+    const bool allFinished = it->primaryFinished && (it->hedgeId == 0 || it->hedgeFinished);
+    const bool report = !it->reported &&
+                        (it->winnerId == requestId || (it->winnerId == 0 && allFinished));
+    if (report) {
+        it->reported = true;
+    }
+    if (allFinished) {
+        if (it->timer) {
+            it->timer->deleteLater();
+        }
+        m_hedgePrimaries.remove(it->hedgeId);
+        m_hedges.erase(it);
+    }
+
+    if (!report) {
+        return false;
+    }
+    requestId = primaryId;
+    return true;
+}
+
+// Samples for the hedge delay, per provider; cached answers would skew them
+void HyniCore::noteFirstByte(quint64 requestId, bool timed) {
+    auto it = m_inFlight.find(requestId);
+    if (it == m_inFlight.end() || !it->awaitingFirstByte) {
+        return;
+    }
+    it->awaitingFirstByte = false;
+    if (timed) {
+        m_firstByte[providerIndex(it->provider)].recordNanos(std::uint64_t(it->submitted.nsecsElapsed()));
+    }
+}
+
+void HyniCore::onPartialResponse(quint64 requestId, const QString& delta) {
+    noteFirstByte(requestId, true);
+    if (!routeHedged(requestId)) {
+        return;
+    }
+
+    auto it = m_inFlight.find(requestId);
+    if (it != m_inFlight.end() && it->firstDelta) {
+        metrics().firstToken.record(std::chrono::nanoseconds(it->submitted.nsecsElapsed()));
+        it->firstDelta = false;
+    }
+
+    auto held = m_held.find(requestId);
+    if (held != m_held.end()) {
+        if (!held->discarded) {
+            held->streamed += delta;
+        }
+        return;
+    }
+    emit partialResponseReceived(requestId, delta);
+}
+
+void HyniCore::onResponse(quint64 requestId, const QString& response, bool fromCache) {
+    noteFirstByte(requestId, !fromCache);
+    if (!routeHedged(requestId)) {
+        return;
+    }
+
+    auto it = m_inFlight.find(requestId);
+    if (it != m_inFlight.end()) {
+        metrics().answer.record(std::chrono::nanoseconds(it->submitted.nsecsElapsed()));
+    }
+
+    auto held = m_held.find(requestId);
+    if (held != m_held.end()) {
+        if (!held->discarded) {
+            held->response = response;
+            held->fromCache = fromCache;
+            held->answered = true;
+
+            // Claimed requests wait here only until their replay
+            if (isSpeculative(requestId) && --m_speculation.unanswered == 0) {
+                m_speculation.answeredNs = m_speculation.dispatched.nsecsElapsed();
+            }
+        }
+        return;
+    }
+    emit responseReceived(requestId, response, fromCache);
+}
+
+void HyniCore::onError(quint64 requestId, const QString& error) {
+    if (!routeHedgedError(requestId)) {
+        qDebug() << "Hedged request" << requestId << "failed:" << error;
+        return;
+    }
+
+    auto held = m_held.find(requestId);
+    if (held != m_held.end() && !held->discarded) {
+        // A failed speculation is not worth claiming; Send asks afresh
+        if (isSpeculative(requestId)) {
+            qDebug() << "Speculative request failed:" << error;
+            discardSpeculation();
+            return;
+        }
+    }
+    if (held != m_held.end() && held->discarded) {
+        return;
+    }
+    emit errorOccurred(requestId, error);
+}
+
+void HyniCore::onRequestFinished(quint64 requestId) {
+    if (!routeHedgedFinished(requestId)) {
+        return;
+    }
+    m_inFlight.remove(requestId);
+
+    auto held = m_held.find(requestId);
+    if (held != m_held.end()) {
+        if (held->discarded) {
+            m_held.erase(held);
+        } else {
+            held->finished = true;
+        }
+        return;
+    }
+    emit requestFinished(requestId);
+}
+
+void HyniCore::onNeedAPIKey() {
+    // Workers started after the key was entered still need it
+    const QString apiKey = m_scheduler->apiKey(provider());
+    if (!apiKey.isEmpty()) {
+        m_scheduler->setAPIKey(provider(), apiKey);
+        return;
+    }
+    emit needApiKey();
+}
+
+void HyniCore::onWatchedImage(const QImage& image, const QElapsedTimer& detected) {
+    const QVector<Submission> submissions = askImage(image);
+    if (submissions.isEmpty()) {
+        return;
+    }
+    metrics().pngPickup.record(std::chrono::nanoseconds(detected.nsecsElapsed()));
+    qDebug() << "Screenshot dispatched" << detected.elapsed() << "ms after it was detected";
+    emit imageSubmitted(submissions);
+}
+
+void HyniCore::onMessagesReceived() {
+    if (!m_transcription) {
+        return;
+    }
+    m_transcription->consumeMessages([this](TranscriptionMessage&& message) {
+        switch (message.type) {
+        case TranscriptionMessage::Type::Transcript:
+            emit transcriptReceived(message.text);
+            break;
+        }
+    });
+}
+
+#ifdef ENABLE_AUDIO_STREAM
+void HyniCore::setVadEnabled(bool enabled) {
+    m_vad.setEnabled(enabled);
+}
+
+void HyniCore::setVadConfig(const VadConfig& config) {
+    // The detector belongs to the io thread
+    boost::asio::post(*m_ioContext, [this, config]() {
+        m_vad.setConfig(config);
+    });
+}
+
+// Runs on the io thread. The client encodes into recycled buffers, so
+// steady-state streaming does not allocate.
+// Runs on the io thread only
+void HyniCore::receiveAudioData() {
+    if (m_audioStopped) {
+        return;
+    }
+    m_streamer->consumeFrames([this](const AudioFrame& frame) {
+        // Leave the frame in the capture ring until the link catches up
+        if (m_transcription->audioQueueFull()) {
+            return false;
+        }
+        ScopedLatency latency(metrics().audioFrame);
+        const auto* bytes = reinterpret_cast<const uint8_t*>(frame.data.data());
+        m_vad.process(bytes, frame.size, [this](const uint8_t* data, std::size_t size) {
+            m_transcription->sendAudio(reinterpret_cast<const int16_t*>(data), size / sizeof(int16_t));
+        });
+        return true;
+    });
+}
+#endif
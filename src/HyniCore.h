@@ -0,0 +1,273 @@
+#ifndef HYNI_CORE_H
+#define HYNI_CORE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <boost/asio.hpp>
+#include <memory>
+#include <thread>
+#include "ChatRequest.h"
+#include "Metrics.h"
+#include "TranscriptionClient.h"
+#include "UtteranceEndDetector.h"
+#include "chat_api.h"
+#ifdef ENABLE_AUDIO_STREAM
+#include "AudioStreamer.h"
+#include "VoiceActivityDetector.h"
+#endif
+
+class ChatRequestScheduler;
+class PngMonitor;
+class QThread;
+class QTimer;
+
+// The question -> answer pipelines without any widgets: the transcription
+// websocket and its io thread, audio capture, the chat worker pool, prompt
+// assembly for the selected question type and the fan-out of coding
+// questions to every language. HyniWindow and the headless qhyni_cli are
+// both thin clients of it.
+//
+// Lives on, and is driven from, the thread that owns its event loop; every
+// signal is emitted there. Requests are identified by the ids of
+// ChatRequestScheduler, which the ask*() calls return per language.
+class HyniCore : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString transcriptionHost{"localhost"};
+        QString transcriptionPort;  // empty: the default for this build
+        bool transcription{true};
+        bool captureAudio{true};    // ENABLE_AUDIO_STREAM builds only
+        QString watchFolder;        // screenshots to pick up, empty for none
+        int workerCount{3};
+        int queueCapacity{8};
+    };
+
+    // One request of an ask*() call; requestId is 0 when it was dropped
+    // because too many requests are in flight.
+    struct Submission {
+        QString language;
+        quint64 requestId{0};
+    };
+
+    struct SpeculationStats {
+        quint64 dispatched{0};  // questions sent before anyone asked
+        quint64 hits{0};        // claimed by askText() with the same question
+        quint64 wasted{0};      // cancelled or superseded instead
+        quint64 misses{0};      // askText() calls with nothing to claim
+        qint64 savedNs{0};      // head start the hits had
+    };
+
+    // When a text question is also sent to the other provider: once the
+    // selected one took longer than this percentile of its past times to
+    // the first answer text.
+    struct HedgeConfig {
+        double percentile{0.9};
+        int minDelayMs{500};
+        int initialDelayMs{2500};  // until minSamples requests were timed
+        int minSamples{10};
+    };
+
+    struct HedgeStats {
+        quint64 watched{0};      // text requests that could be hedged
+        quint64 fired{0};        // sent to the other provider as well
+        quint64 hedgeWins{0};    // the other provider answered first
+        quint64 primaryWins{0};  // the selected one still answered first
+    };
+
+    explicit HyniCore(const Options& options, QObject *parent = nullptr);
+    ~HyniCore();
+
+    static QString defaultTranscriptionPort();
+
+    // Connects to the transcription server and starts capturing audio
+    void start();
+
+    hyni::chat_api::QUESTION_TYPE questionType() const { return m_questionType; }
+    void setQuestionType(hyni::chat_api::QUESTION_TYPE type);
+
+    // The first language answers everything; coding questions are asked
+    // once per language.
+    QStringList languages() const { return m_languages; }
+    void setLanguages(const QStringList& languages);
+
+    hyni::chat_api::API_PROVIDER provider() const;
+    void setProvider(hyni::chat_api::API_PROVIDER provider);
+    bool supportsImages() const;
+    bool hasImage() const;
+
+    // For the selected provider; handed to every worker that asks for a key
+    void setAPIKey(const QString& apiKey);
+    void setStreamingEnabled(bool enabled);
+    void setCacheEnabled(bool enabled);
+
+    // Text questions can be sent speculatively: updateUtterance() is given
+    // the text a Send would ask whenever it changes, and once the speaker
+    // seems done it is submitted. Its answer is held back until askText()
+    // asks the same question and claims it, and cancelled when more speech
+    // arrives first. Off by default.
+    void setSpeculationEnabled(bool enabled);
+    bool speculationEnabled() const { return m_speculationEnabled; }
+    void setUtteranceEndConfig(const UtteranceEndConfig& config);
+    void updateUtterance(const QString& text);
+    SpeculationStats speculationStats() const { return m_speculationStats; }
+
+    // Hedging sends slow text questions to the other provider too; the
+    // first to stream wins and the other is cancelled. Callers only ever
+    // see the id the ask*() call returned. Needs a key for the other
+    // provider, entered or in its environment variable. Speculative
+    // requests are not hedged. Off by default.
+    void setHedgingEnabled(bool enabled);
+    bool hedgingEnabled() const { return m_hedgingEnabled; }
+    void setHedgeConfig(const HedgeConfig& config);
+    HedgeStats hedgeStats() const { return m_hedgeStats; }
+    int hedgeDelayMs() const;
+
+    QVector<Submission> askText(const QString& text);
+    QVector<Submission> askImage(const QImage& image);
+    QVector<Submission> resendImage();
+    void cancelAll();
+
+    int inFlightCount() const { return m_inFlight.size(); }
+
+    ChatRequestScheduler* scheduler() const { return m_scheduler; }
+    TranscriptionClient* transcription() const { return m_transcription.get(); }
+#ifdef ENABLE_AUDIO_STREAM
+    AudioStreamer* audioStreamer() const { return m_streamer; }
+    VoiceActivityDetector::Stats vadStats() const { return m_vad.stats(); }
+    void setVadEnabled(bool enabled);
+    void setVadConfig(const VadConfig& config);
+#endif
+
+signals:
+    void transcriptReceived(const QString& text);
+    void transcriptionConnected(bool connected);
+    void transcriptionError(const QString& error);
+
+    // Screenshots from the watched folder, already submitted
+    void imageSubmitted(const QVector<HyniCore::Submission>& submissions);
+
+    void partialResponseReceived(quint64 requestId, const QString& delta);
+    void responseReceived(quint64 requestId, const QString& response, bool fromCache);
+    void errorOccurred(quint64 requestId, const QString& error);
+    void requestFinished(quint64 requestId);
+
+    // No key in the environment and none set yet
+    void needApiKey();
+    void warning(const QString& message);
+
+private:
+    void onMessagesReceived();
+    void onWatchedImage(const QImage& image, const QElapsedTimer& detected);
+    void onNeedAPIKey();
+    void onPartialResponse(quint64 requestId, const QString& delta);
+    void onResponse(quint64 requestId, const QString& response, bool fromCache);
+    void onError(quint64 requestId, const QString& error);
+    void onRequestFinished(quint64 requestId);
+    void onUtteranceEnded(const QString& text);
+    ChatRequest textRequest(const QString& text) const;
+    bool speculationMatches(const QString& text) const;
+    bool isSpeculative(quint64 requestId) const;
+    QVector<Submission> claimSpeculation();
+    void discardSpeculation();
+    void replayHeld(const QVector<Submission>& submissions);
+    // Speculative requests are never hedged
+    QVector<Submission> submitForLanguages(ChatRequest request, bool speculative = false);
+    quint64 submit(ChatRequest request, bool speculative);
+    void cancelRequest(quint64 requestId);
+    hyni::chat_api::API_PROVIDER hedgeProvider() const;
+    bool canHedge() const;
+    void fireHedge(quint64 requestId);
+    bool routeHedged(quint64& requestId);
+    bool routeHedgedError(quint64& requestId);
+    bool routeHedgedFinished(quint64& requestId);
+    void noteFirstByte(quint64 requestId, bool timed);
+    void stopTransport();
+#ifdef ENABLE_AUDIO_STREAM
+    void receiveAudioData();
+#endif
+
+    struct InFlight {
+        QElapsedTimer submitted;
+        hyni::chat_api::API_PROVIDER provider{hyni::chat_api::API_PROVIDER::OpenAI};
+        bool firstDelta{true};
+        bool awaitingFirstByte{true};  // per provider, hedges included
+    };
+
+    // A hedged request and its copy for the other provider, by the id its
+    // caller knows
+    struct Hedge {
+        ChatRequest request;  // for the other provider
+        QTimer* timer{nullptr};
+        quint64 hedgeId{0};
+        quint64 winnerId{0};  // first to stream or answer
+        bool primaryFailed{false};
+        bool primaryFinished{false};
+        bool hedgeFailed{false};
+        bool hedgeFinished{false};
+        bool reported{false};  // requestFinished emitted
+    };
+
+    // What was asked speculatively, to tell whether askText() asks the same
+    struct Speculation {
+        QString question;  // simplified
+        hyni::chat_api::QUESTION_TYPE type{hyni::chat_api::QUESTION_TYPE::General};
+        QStringList languages;
+        hyni::chat_api::API_PROVIDER provider{hyni::chat_api::API_PROVIDER::OpenAI};
+        QVector<Submission> submissions;
+        QElapsedTimer dispatched;
+        int unanswered{0};
+        qint64 answeredNs{-1};  // all answers complete, after dispatch
+    };
+
+    // Events of a speculative request, not emitted until it is claimed
+    struct HeldResponse {
+        QString streamed;
+        QString response;
+        bool answered{false};
+        bool fromCache{false};
+        bool finished{false};
+        bool discarded{false};  // dropped silently once finished
+    };
+
+    Options m_options;
+    hyni::chat_api::QUESTION_TYPE m_questionType{hyni::chat_api::QUESTION_TYPE::Coding};
+    QStringList m_languages;
+
+    ChatRequestScheduler* m_scheduler{nullptr};
+    QHash<quint64, InFlight> m_inFlight;
+
+    bool m_speculationEnabled{false};
+    UtteranceEndDetector* m_utteranceEnd{nullptr};
+    Speculation m_speculation;  // none while it has no submissions
+    QHash<quint64, HeldResponse> m_held;
+    SpeculationStats m_speculationStats;
+
+    bool m_hedgingEnabled{false};
+    HedgeConfig m_hedgeConfig;
+    HedgeStats m_hedgeStats;
+    QHash<quint64, Hedge> m_hedges;
+    QHash<quint64, quint64> m_hedgePrimaries;  // hedge id -> the caller's id
+    // Times to the first answer text, OpenAI and DeepSeek
+    LatencyHistogram m_firstByte[2];
+    PngMonitor* m_pngMonitor{nullptr};
+
+    std::unique_ptr<boost::asio::io_context> m_ioContext;
+    std::shared_ptr<TranscriptionClient> m_transcription;
+    std::thread m_ioThread;
+#ifdef ENABLE_AUDIO_STREAM
+    AudioStreamer* m_streamer{nullptr};
+    bool m_audioStopped{false};  // io thread only; the streamer is going away
+    QThread* m_audioThread{nullptr};
+    VoiceActivityDetector m_vad;
+#endif
+};
+
+Q_DECLARE_METATYPE(HyniCore::Submission)
+
+#endif // HYNI_CORE_H
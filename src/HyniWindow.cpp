@@ -1,25 +1,61 @@
 #include "HyniWindow.h"
-#include "ChatAPIWorker.h"
+#include "Metrics.h"
+#include "MetricsExporter.h"
+#include "MetricsPanel.h"
 #include "config.h"
 #include <QTimer>
 #include <QThread>
 #include <QMessageBox>
 #include <QInputDialog>
+#include <QFileDialog>
 #include <QDebug>
 #include <qapplication.h>
 #include <qevent.h>
-#include <QProcess>
-#include <QFile>
 #include <QMenuBar>
 #include <QActionGroup>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+// Minimum time between two repaints of a streamed response
+constexpr int STREAM_FLUSH_INTERVAL_MS = 100;
+
+// Where screenshots taken on another machine are synced to
+const char* const SCREENSHOT_FOLDER = "/home/jwongso/Dropbox/BabaYaga";
+
+// How often an exported metrics file is rewritten
+constexpr int METRICS_EXPORT_INTERVAL_MS = 15000;
+
+struct WindowMetrics {
+    LatencyHistogram& screenGrab = MetricsRegistry::global().histogram(
+        "qhyni_screen_grab_seconds", "Grabbing the screen, without the capture delay");
+    LatencyHistogram& screenConvert = MetricsRegistry::global().histogram(
+        "qhyni_screen_convert_seconds", "Converting a grabbed screen to a QImage");
+    LatencyHistogram& renderMarkdown = MetricsRegistry::global().histogram(
+        "qhyni_render_markdown_seconds", "Rendering an answer with setMarkdown");
+};
+
+WindowMetrics& metrics() {
+    static WindowMetrics metrics;
+    return metrics;
+}
+}
 
 HyniWindow::HyniWindow(QWidget *parent)
-    : QMainWindow(parent), reconnectTimer(std::make_unique<QTimer>(this)),
-    io_context(std::make_unique<boost::asio::io_context>()),
-    m_png_monitor("/home/jwongso/Dropbox/BabaYaga")
+    : QMainWindow(parent)
 {
     setWindowTitle("Qhyni - hyni UI with gen AI and real-time transcription");
 
+    HyniCore::Options options;
+    options.watchFolder = SCREENSHOT_FOLDER;
+    m_core = new HyniCore(options, this);
+
+    // Created before the menus that control them
+    m_metricsExporter = new MetricsExporter(this);
+    m_metricsPanel = new MetricsPanel(this);
+    addDockWidget(Qt::RightDockWidgetArea, m_metricsPanel);
+    m_metricsPanel->hide();
+
     QMenuBar *menuBar = new QMenuBar(this);
     menuBar->setNativeMenuBar(false);
     setMenuBar(menuBar);
@@ -71,6 +107,16 @@ HyniWindow::HyniWindow(QWidget *parent)
     questionTypeLayout->addWidget(codingOption);
     questionTypeBox->setLayout(questionTypeLayout);
 
+    // Watched screenshots are asked with whatever is selected
+    for (QRadioButton* option : {generalOption, amazonStarOption, systemDesignOption, codingOption}) {
+        connect(option, &QRadioButton::toggled, this, [this](bool checked) {
+            if (checked) {
+                m_core->setQuestionType(currentQuestionType());
+            }
+        });
+    }
+    m_core->setQuestionType(currentQuestionType());
+
     leftLayout->addWidget(leftSplitter);
     leftLayout->addWidget(questionTypeBox);
 
@@ -100,51 +146,38 @@ HyniWindow::HyniWindow(QWidget *parent)
 
     setCentralWidget(centralWidget);
 
-#ifdef ENABLE_AUDIO_STREAM
-    websocketClient = std::make_shared<hyni_websocket_client>(*io_context, "localhost", "8765");
-#else
-    websocketClient = std::make_shared<hyni_websocket_client>(*io_context, "localhost", "8080");
-#endif
-    websocketClient->set_message_handler([this](const std::string& message) {
-        QMetaObject::invokeMethod(this, [this, message]() {
-            onMessageReceived(message);
-        });
+    connect(m_core, &HyniCore::transcriptReceived, highlightTableWidget, &HighlightTableWidget::queueText);
+    connect(highlightTableWidget, &HighlightTableWidget::lastRowChanged, m_core, &HyniCore::updateUtterance);
+    connect(m_core, &HyniCore::transcriptionConnected, this, &HyniWindow::onWebSocketConnected);
+    connect(m_core, &HyniCore::transcriptionError, this, &HyniWindow::onWebSocketError);
+    connect(m_core, &HyniCore::partialResponseReceived, this, &HyniWindow::handleAPIPartialResponse);
+    connect(m_core, &HyniCore::responseReceived, this, &HyniWindow::handleAPIResponse);
+    connect(m_core, &HyniCore::errorOccurred, this, &HyniWindow::handleAPIError);
+    connect(m_core, &HyniCore::requestFinished, this, &HyniWindow::handleRequestFinished);
+    connect(m_core, &HyniCore::needApiKey, this, &HyniWindow::handleNeedAPIKey);
+    connect(m_core, &HyniCore::imageSubmitted, this, &HyniWindow::handleImageSubmitted);
+    connect(m_core, &HyniCore::warning, this, [this](const QString& message) {
+        statusBar()->showMessage(message, 5000);
     });
-    websocketClient->set_connection_handler([this](bool connected) {
-        QMetaObject::invokeMethod(this, [this, connected]() {
-            onWebSocketConnected(connected);
-        });
-    });
-    websocketClient->set_error_handler([this](const std::string& error) {
-        QMetaObject::invokeMethod(this, [this, error]() {
-            onWebSocketError(error);
-        });
-    });
-
-    // Start IO context in a separate thread
-    io_thread = std::thread([this]() {
-        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard(io_context->get_executor());
-        io_context->run();
-    });
-
-    // Reconnect logic
-    connect(reconnectTimer.get(), &QTimer::timeout, this, &HyniWindow::attemptReconnect);
-    reconnectTimer->start(3000); // Try reconnecting every 3 seconds
 
-    attemptReconnect(); // Try initial connection
-    statusBar()->showMessage("Disconnected");
+    m_core->start();
+    statusBar()->showMessage("Connecting...");
 
-    setupAPIWorkers();
+    m_streamFlushTimer = new QTimer(this);
+    m_streamFlushTimer->setSingleShot(true);
+    m_streamFlushTimer->setInterval(STREAM_FLUSH_INTERVAL_MS);
+    connect(m_streamFlushTimer, &QTimer::timeout, this, &HyniWindow::flushStreamedText);
 
-    connect(&m_png_monitor, &PngMonitor::sendImage, this, &HyniWindow::handleCapturedScreen);
-
-#ifdef ENABLE_AUDIO_STREAM
-    QObject::connect(&m_streamer, &AudioStreamer::audioDataReady, this, &HyniWindow::receiveAudioData);
-    m_streamer.startRecording();
-#endif
+    // Grab in-process; spectacle takes over where the platform refuses
+    m_screenCapture = new QScreenCapture(this);
+    m_fallbackCapture = new SpectacleCapture(this);
+    for (ScreenCaptureBackend* backend : {m_screenCapture, m_fallbackCapture}) {
+        connect(backend, &ScreenCaptureBackend::captured, this, &HyniWindow::handleScreenCaptured);
+        connect(backend, &ScreenCaptureBackend::failed, this, &HyniWindow::handleScreenCaptureFailed);
+    }
 }
 
-void HyniWindow::addResponseTab(const QString& language) {
+QTextEdit* HyniWindow::addResponseTab(const QString& language, int index) {
     QTextEdit *editor = new QTextEdit(this);
     editor->setPlaceholderText(language + " Response");
     editor->setReadOnly(true);
@@ -153,8 +186,63 @@ void HyniWindow::addResponseTab(const QString& language) {
     font.setPointSize(font.pointSize() + 1);
     editor->setFont(font);
 
-    tabWidget->addTab(editor, language);
-    responseEditors.push_back(editor);
+    if (index < 0 || index >= tabWidget->count()) {
+        tabWidget->addTab(editor, language);
+        responseEditors.push_back(editor);
+    } else {
+        tabWidget->insertTab(index, editor, language);
+        responseEditors.insert(index, editor);
+    }
+    syncLanguages();
+    return editor;
+}
+
+bool HyniWindow::removeResponseTab(const QString& language) {
+    const QVector<QTextEdit*> editors = languageEditors();
+
+    // Keep at least one language tab
+    if (editors.size() <= 1) {
+        return false;
+    }
+
+    for (QTextEdit* editor : editors) {
+        if (languageOf(editor) == language) {
+            tabWidget->removeTab(tabWidget->indexOf(editor));
+            responseEditors.removeOne(editor);
+            m_editorOwners.remove(editor);
+            editor->deleteLater();
+            syncLanguages();
+            return true;
+        }
+    }
+    return false;
+}
+
+// All response editors except History, which is always the last tab.
+QVector<QTextEdit*> HyniWindow::languageEditors() const {
+    return responseEditors.mid(0, responseEditors.size() - 1);
+}
+
+QString HyniWindow::languageOf(QTextEdit* editor) const {
+    return tabWidget->tabText(tabWidget->indexOf(editor)).remove('&');
+}
+
+QTextEdit* HyniWindow::editorFor(const QString& language) const {
+    for (QTextEdit* editor : languageEditors()) {
+        if (languageOf(editor) == language) {
+            return editor;
+        }
+    }
+    return nullptr;
+}
+
+// The core asks in the languages of the tabs, first tab first
+void HyniWindow::syncLanguages() {
+    QStringList languages;
+    for (QTextEdit* editor : languageEditors()) {
+        languages.append(languageOf(editor));
+    }
+    m_core->setLanguages(languages);
 }
 
 void HyniWindow::onLanguageChanged(QAction* action) {
@@ -164,6 +252,17 @@ void HyniWindow::onLanguageChanged(QAction* action) {
     }
 
     const QString newLang = action->data().toString();
+
+    // Each checked language has its own tab
+    if (m_multiLanguageAction->isChecked()) {
+        if (action->isChecked()) {
+            addResponseTab(newLang, tabWidget->count() - 1);
+        } else if (!removeResponseTab(newLang)) {
+            action->setChecked(true);
+        }
+        return;
+    }
+
     const QString oldLang = tabWidget->tabText(0).remove('&');
 
     // Skip if language isn't actually changing
@@ -176,116 +275,192 @@ void HyniWindow::onLanguageChanged(QAction* action) {
 
     // Update UI and data structures
     tabWidget->setTabText(0, newLang);
+    syncLanguages();
 
     // Update editor properties
     editor->clear();
     editor->setPlaceholderText(newLang + " Response");
 }
 
-HyniWindow::~HyniWindow() {
-#ifdef ENABLE_AUDIO_STREAM
-    m_streamer.stopRecording();
-#endif
-    reconnectTimer->stop();
-    reconnectTimer.reset();
+void HyniWindow::onMultiLanguageToggled(bool enabled) {
+    m_langGroup->setExclusive(!enabled);
 
-    if (websocketClient) {
-        websocketClient->shutdown(); // Your existing method
-        websocketClient.reset();
+    if (enabled) {
+        statusBar()->showMessage("Coding questions are sent for every checked language", 3000);
+        return;
     }
 
-    if (io_context) {
-        io_context->stop(); // Signal stop to ASIO
-
-        if (io_thread.joinable()) {
-            // Give 500ms for graceful shutdown
-            for (int i = 0; i < 50; ++i) {
-                if (!io_thread.joinable()) break;
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
+    // Back to a single language: keep the first tab only
+    const QString keep = tabWidget->tabText(0).remove('&');
+    while (languageEditors().size() > 1) {
+        removeResponseTab(languageOf(languageEditors().last()));
+    }
 
-            if (io_thread.joinable()) {
-                // Last resort
-                io_context.reset(); // Destroy io_context first
-                io_thread.detach();
-            }
-        }
+    for (QAction* action : m_langGroup->actions()) {
+        action->setChecked(action->data().toString() == keep);
     }
+}
 
-    cleanupAPIWorkers();
+HyniWindow::~HyniWindow() {
+    // Stopped before the widgets its signals update are gone
+    m_core->disconnect(this);
+    delete m_core;
+    m_core = nullptr;
 }
 
-void HyniWindow::cleanupAPIWorkers() {
-    if (thread) {
-        thread->quit();
-        if (!thread->wait(500)) {
-            thread->terminate();
-            thread->wait();
+void HyniWindow::trackSubmissions(const QVector<HyniCore::Submission>& submissions) {
+    for (const HyniCore::Submission& submission : submissions) {
+        if (submission.requestId == 0) {
+            statusBar()->showMessage("Request dropped - too many requests in flight", 5000);
+            continue;
+        }
+
+        QTextEdit* editor = editorFor(submission.language);
+        if (!editor) {
+            continue;
         }
-        delete thread;
+
+        // The newest request for an editor owns it; older ones still complete
+        // and end up in the History tab.
+        m_pendingResponses.insert(submission.requestId, PendingResponse{editor});
+        m_editorOwners.insert(editor, submission.requestId);
+        editor->setPlainText("Processing...");
     }
 }
 
-void HyniWindow::setupAPIWorkers() {
-    thread = new QThread(this);
-    worker = new ChatAPIWorker();
+void HyniWindow::handleAPIPartialResponse(quint64 requestId, const QString& delta) {
+    auto it = m_pendingResponses.find(requestId);
+    if (it == m_pendingResponses.end()) {
+        return;
+    }
+    it->streamText += delta;
 
-    if (!m_sharedApiKey.isEmpty()) {
-        worker->setAPIKey(m_sharedApiKey);
+    // The first chunk is shown right away, later ones are batched so the
+    // editors are repainted at most once per flush interval.
+    if (!m_streamFlushTimer->isActive()) {
+        flushStreamedText();
+        m_streamFlushTimer->start();
     }
+}
 
-    worker->moveToThread(thread);
+void HyniWindow::flushStreamedText() {
+    for (auto it = m_pendingResponses.begin(); it != m_pendingResponses.end(); ++it) {
+        PendingResponse& pending = it.value();
+        if (pending.streamText.isEmpty()) {
+            continue;
+        }
 
-    connect(worker, &ChatAPIWorker::responseReceived,
-            this, [this](const QString& response) {
-                handleAPIResponse(response);
-            });
-    connect(worker, &ChatAPIWorker::errorOccurred,
-            this, [this](const QString& error) {
-                handleAPIError(error);
-            });
-    connect(worker, &ChatAPIWorker::needApiKey,
-            this, [this]() {
-                handleNeedAPIKey();
-            });
+        if (!pending.editor || m_editorOwners.value(pending.editor) != it.key()) {
+            pending.streamText.clear();
+            continue;
+        }
 
-    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        if (!pending.started) {
+            pending.editor->clear();
+            pending.started = true;
+        }
 
-    thread->start();
+        QTextCursor cursor(pending.editor->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(pending.streamText);
+        pending.streamText.clear();
+    }
 }
 
-void HyniWindow::handleAPIResponse(const QString& response) {
-    responseEditors.first()->setMarkdown(response);
-    m_history.push_back(response);
+void HyniWindow::handleAPIResponse(quint64 requestId, const QString& response, bool fromCache) {
+    auto it = m_pendingResponses.find(requestId);
+    if (it != m_pendingResponses.end()) {
+        it->answered = true;
+    }
+    const PendingResponse pending = m_pendingResponses.value(requestId);
+    const bool ownsEditor = pending.editor && m_editorOwners.value(pending.editor) == requestId;
+
+    // The streamed plain text is replaced by the fully rendered answer
+    if (ownsEditor) {
+        ScopedLatency render(metrics().renderMarkdown);
+        if (fromCache) {
+            pending.editor->setMarkdown("*Cached answer - disable the response cache in the AI menu to ask again*\n\n---\n\n" + response);
+        } else {
+            pending.editor->setMarkdown(response);
+        }
+    }
     qDebug() << response;
 
     if (responseEditors.count() > 1) {
-        QString history;
-        for (const auto& page : m_history) {
-            history += page;
-            history += "\n\n---\n\n";
-        }
+        appendToHistory(response);
+    }
+
+    if (ownsEditor) {
+        const int tabIndex = tabWidget->indexOf(pending.editor);
+        statusBar()->showMessage(tabWidget->tabText(tabIndex).remove('&') +
+                                 (fromCache ? " response received from cache" : " response received"), 3000);
+    } else {
+        statusBar()->showMessage("Earlier response added to History", 3000);
+    }
+}
+
+// Only the new entry is parsed and laid out; re-rendering the whole session
+// on every answer made long sessions progressively slower.
+void HyniWindow::appendToHistory(const QString& response) {
+    QTextDocument* document = responseEditors.last()->document();
+    QTextCursor cursor(document);
+    cursor.movePosition(QTextCursor::End);
+
+    if (!document->isEmpty()) {
+        cursor.insertBlock();
+        cursor.insertMarkdown("---");
+        cursor.insertBlock();
+    }
+    cursor.insertMarkdown(response);
+}
+
+// Ends the text of a request that owns its editor but got no answer. Text
+// streamed so far stays, marked so it can't pass for a complete answer.
+void HyniWindow::markUnanswered(quint64 requestId, const QString& marker) {
+    const PendingResponse pending = m_pendingResponses.value(requestId);
+    if (!pending.editor || m_editorOwners.value(pending.editor) != requestId) {
+        return;
+    }
+
+    flushStreamedText();
+    if (m_pendingResponses.value(requestId).started) {
+        QTextCursor cursor(pending.editor->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText("\n\n[" + marker + "]");
+    } else {
+        pending.editor->setPlainText("[" + marker + "]");
+    }
+}
 
-        if (!history.isEmpty()) {
-            responseEditors.last()->setMarkdown(history);
+void HyniWindow::handleAPIError(quint64 requestId, const QString& error) {
+    QString message = error;
+    auto it = m_pendingResponses.find(requestId);
+    if (it != m_pendingResponses.end()) {
+        it->answered = true;
+        if (it->editor) {
+            message = languageOf(it->editor) + ": " + error;
         }
+        markUnanswered(requestId, "Request failed: " + error);
     }
 
-    statusBar()->showMessage(tabWidget->tabText(0).remove('&') + " response received", 3000);
+    QMessageBox::warning(this, "API Error", message);
+    statusBar()->showMessage(message, 5000);
 }
 
-void HyniWindow::handleAPIError(const QString& error) {
-    QMessageBox::warning(this, "API Error", error);
-    statusBar()->showMessage(error, 5000);
+void HyniWindow::handleRequestFinished(quint64 requestId) {
+    if (!m_pendingResponses.value(requestId).answered) {
+        markUnanswered(requestId, "No answer received");
+    }
+
+    const PendingResponse pending = m_pendingResponses.take(requestId);
+    if (pending.editor && m_editorOwners.value(pending.editor) == requestId) {
+        m_editorOwners.remove(pending.editor);
+    }
 }
 
 void HyniWindow::handleNeedAPIKey() {
-    // If we already have a key or are in the process of requesting one
-    if (!m_sharedApiKey.isEmpty() || m_apiKeyRequested) {
-        if (!m_sharedApiKey.isEmpty()) {
-            // Distribute the existing key to all workers
-            worker->setAPIKey(m_sharedApiKey);
-        }
+    // Only asked once the core has no key to hand out
+    if (m_apiKeyRequested) {
         return;
     }
 
@@ -293,9 +468,9 @@ void HyniWindow::handleNeedAPIKey() {
 
     bool ok;
     QString label = "Enter your API Key for ";
-    if (worker->getProvider() == hyni::chat_api::API_PROVIDER::OpenAI) {
+    if (m_core->provider() == hyni::chat_api::API_PROVIDER::OpenAI) {
         label += "Open AI";
-    } else if (worker->getProvider() == hyni::chat_api::API_PROVIDER::DeepSeek) {
+    } else if (m_core->provider() == hyni::chat_api::API_PROVIDER::DeepSeek) {
         label += "DeepSeek";
     } else {
         label += "Unknown";
@@ -306,9 +481,8 @@ void HyniWindow::handleNeedAPIKey() {
     m_apiKeyRequested = false;
 
     if (ok && !userKey.isEmpty()) {
-        m_sharedApiKey = userKey;
-        // Distribute the key to all workers
-        worker->setAPIKey(m_sharedApiKey);
+        // Distributed to all workers
+        m_core->setAPIKey(userKey);
     } else {
         statusBar()->showMessage("No API-Key available");
     }
@@ -365,6 +539,49 @@ void HyniWindow::setupMenuBar(QMenuBar* menuBar) {
     aiGroup->addAction(deepSeekAction);
     aiMenu->addAction(deepSeekAction);
 
+    aiMenu->addSeparator();
+
+    // Stream tokens into the response tab as they arrive. Off by default:
+    // streamed requests skip hyni's system prompts and model selection.
+    QAction *streamAction = new QAction("&Stream responses", this);
+    streamAction->setCheckable(true);
+    streamAction->setChecked(false);
+    aiMenu->addAction(streamAction);
+    connect(streamAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->setStreamingEnabled(checked);
+    });
+
+    // Serve identical resends from the local response cache
+    QAction *cacheAction = new QAction("Use response &cache", this);
+    cacheAction->setCheckable(true);
+    cacheAction->setChecked(true);
+    aiMenu->addAction(cacheAction);
+    connect(cacheAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->setCacheEnabled(checked);
+    });
+
+    // Ask once the speaker seems done, so Send finds the answer underway
+    QAction *speculateAction = new QAction("Ask &early on pauses", this);
+    speculateAction->setCheckable(true);
+    speculateAction->setChecked(m_core->speculationEnabled());
+    speculateAction->setToolTip("Send the transcript when speech pauses or a question ends; "
+                                "more speech cancels it");
+    aiMenu->addAction(speculateAction);
+    connect(speculateAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->setSpeculationEnabled(checked);
+    });
+
+    // Slow answers are asked of the other provider too, the first one wins
+    QAction *hedgeAction = new QAction("&Hedge with the other provider", this);
+    hedgeAction->setCheckable(true);
+    hedgeAction->setChecked(m_core->hedgingEnabled());
+    hedgeAction->setToolTip("Also send text questions to the other provider when the first "
+                            "answer is later than usual");
+    aiMenu->addAction(hedgeAction);
+    connect(hedgeAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->setHedgingEnabled(checked);
+    });
+
     // Add separator to visually group the exit action
     aiMenu->addSeparator();
 
@@ -417,15 +634,52 @@ void HyniWindow::setupMenuBar(QMenuBar* menuBar) {
     // Screenshot (P)
     QAction *screenshotAction = new QAction("&Screenshot", this);
     screenshotAction->setShortcut(Qt::Key_P);
-    connect(screenshotAction, &QAction::triggered, this, [this]() {
-        QTimer::singleShot(3000, this, &HyniWindow::captureScreen);
-    });
+    connect(screenshotAction, &QAction::triggered, this, &HyniWindow::captureScreen);
     actionsMenu->addAction(screenshotAction);
 
+    QMenu *screenshotMenu = actionsMenu->addMenu("Screenshot se&ttings");
+    QActionGroup *delayGroup = new QActionGroup(this);
+    delayGroup->setExclusive(true);
+    const QVector<QPair<QString, int>> delays = {
+        {"&No delay", 0},
+        {"&1 second delay", 1000},
+        {"&3 seconds delay", 3000},
+        {"&5 seconds delay", 5000}
+    };
+    for (const auto& [name, delayMs] : delays) {
+        QAction *action = screenshotMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(delayMs == m_captureOptions.delayMs);
+        delayGroup->addAction(action);
+        connect(action, &QAction::triggered, this, [this, delayMs = delayMs]() {
+            m_captureOptions.delayMs = delayMs;
+        });
+    }
+    screenshotMenu->addSeparator();
+
+    QAction *regionAction = screenshotMenu->addAction("&Region...");
+    connect(regionAction, &QAction::triggered, this, &HyniWindow::setScreenCaptureRegion);
+
+    QAction *spectacleAction = screenshotMenu->addAction("Use &spectacle");
+    spectacleAction->setCheckable(true);
+    spectacleAction->setToolTip("Capture the active window with spectacle instead of grabbing the whole "
+                                "screen directly; a region is cut from the full screen");
+    connect(spectacleAction, &QAction::toggled, this, [this](bool checked) {
+        if (checked != (m_screenCapture->name() == "spectacle")) {
+            std::swap(m_screenCapture, m_fallbackCapture);
+        }
+    });
+
     // Languages Menu
     QMenu *languagesMenu = menuBar->addMenu("&Languages");
-    QActionGroup *langGroup = new QActionGroup(this);
-    langGroup->setExclusive(true);
+    m_multiLanguageAction = new QAction("&Multiple languages", this);
+    m_multiLanguageAction->setCheckable(true);
+    m_multiLanguageAction->setToolTip("Send coding questions for every checked language at once");
+    languagesMenu->addAction(m_multiLanguageAction);
+    languagesMenu->addSeparator();
+
+    m_langGroup = new QActionGroup(this);
+    m_langGroup->setExclusive(true);
     const QVector<QString> languages = {
         {"C++"},
         {"C#"},
@@ -440,7 +694,7 @@ void HyniWindow::setupMenuBar(QMenuBar* menuBar) {
         QAction *action = new QAction(lang, this);
         action->setCheckable(true);
         action->setData(lang);
-        langGroup->addAction(action);
+        m_langGroup->addAction(action);
         languagesMenu->addAction(action);
 
         if (hyni::DEFAULT_PROG_LANGUAGE == lang.toStdString()) {
@@ -448,13 +702,149 @@ void HyniWindow::setupMenuBar(QMenuBar* menuBar) {
         }
     }
 
-    connect(langGroup, &QActionGroup::triggered, this, &HyniWindow::onLanguageChanged);
+    connect(m_langGroup, &QActionGroup::triggered, this, &HyniWindow::onLanguageChanged);
+    connect(m_multiLanguageAction, &QAction::toggled, this, &HyniWindow::onMultiLanguageToggled);
+
+#ifdef ENABLE_AUDIO_STREAM
+    // Audio Menu
+    QMenu *audioMenu = menuBar->addMenu("Au&dio");
+    m_vadAction = new QAction("&Suppress silence", this);
+    m_vadAction->setCheckable(true);
+    m_vadAction->setChecked(true);
+    m_vadAction->setToolTip("Only stream audio to the transcription server while someone is speaking");
+    audioMenu->addAction(m_vadAction);
+    connect(m_vadAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->setVadEnabled(checked);
+        statusBar()->showMessage(checked ? "Silence suppression enabled" : "Streaming all audio", 2000);
+    });
+
+    QMenu *sensitivityMenu = audioMenu->addMenu("Speech &threshold");
+    QActionGroup *sensitivityGroup = new QActionGroup(this);
+    sensitivityGroup->setExclusive(true);
+    const QVector<QPair<QString, VadConfig>> presets = {
+        {"&Quiet room", {-52.0, 6.0}},
+        {"&Normal", {}},
+        {"No&isy room", {-38.0, 12.0}}
+    };
+    for (const auto& [name, config] : presets) {
+        QAction *action = sensitivityMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(name == "&Normal");
+        sensitivityGroup->addAction(action);
+
+        connect(action, &QAction::triggered, this, [this, config = config]() {
+            m_core->setVadConfig(config);
+        });
+    }
+
+    // Only enable against servers that negotiate codecs, see TranscriptionClient
+    QAction *compressAction = new QAction("&Compress audio", this);
+    compressAction->setCheckable(true);
+    compressAction->setToolTip("Send IMA-ADPCM instead of raw PCM when the transcription server supports it");
+    audioMenu->addAction(compressAction);
+    connect(compressAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->transcription()->setCompressionEnabled(checked);
+    });
+
+    // Likewise only for servers that negotiate it
+    QAction *resumeAction = new QAction("&Resume stream after reconnect", this);
+    resumeAction->setCheckable(true);
+    resumeAction->setToolTip("Replay the last seconds of audio with sequence numbers so the server can drop what it already has");
+    audioMenu->addAction(resumeAction);
+    connect(resumeAction, &QAction::toggled, this, [this](bool checked) {
+        m_core->transcription()->setResumeEnabled(checked);
+    });
+
+    QMenu *overflowMenu = audioMenu->addMenu("When the &link is slow");
+    QActionGroup *overflowGroup = new QActionGroup(this);
+    overflowGroup->setExclusive(true);
+    const QVector<QPair<QString, OverflowPolicy>> policies = {
+        {"Drop &oldest audio", OverflowPolicy::DropOldest},
+        {"Drop &newest audio", OverflowPolicy::DropNewest},
+        {"&Pause capture", OverflowPolicy::BlockCapture}
+    };
+    for (const auto& [name, policy] : policies) {
+        QAction *action = overflowMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(policy == OverflowPolicy::DropOldest);
+        overflowGroup->addAction(action);
+        connect(action, &QAction::triggered, this, [this, policy = policy]() {
+            m_core->transcription()->setAudioQueue(TranscriptionClient::DEFAULT_AUDIO_QUEUE, policy);
+        });
+    }
+
+    audioMenu->addSeparator();
+    QAction *audioStatsAction = audioMenu->addAction("Audio s&tatistics...");
+    connect(audioStatsAction, &QAction::triggered, this, &HyniWindow::showAudioStats);
+#endif
 
     QMenu *viewMenu = menuBar->addMenu("&View");
     QAction *zoomInAction = viewMenu->addAction("Zoom &In");
     zoomInAction->setShortcut(QKeySequence::ZoomIn);
     QAction *zoomOutAction = viewMenu->addAction("Zoom &Out");
     zoomOutAction->setShortcut(QKeySequence::ZoomOut);
+    viewMenu->addSeparator();
+
+    // Fast talkers send bursts of transcripts; lay them out in batches
+    QMenu *transcriptUpdatesMenu = viewMenu->addMenu("Transcript &updates");
+    QActionGroup *updateGroup = new QActionGroup(this);
+    updateGroup->setExclusive(true);
+    const QVector<QPair<QString, int>> updateIntervals = {
+        {"Every &frame", HighlightTableWidget::FRAME_INTERVAL},
+        {"Every &100 ms", 100},
+        {"Every &250 ms", 250}
+    };
+    for (const auto& [name, intervalMs] : updateIntervals) {
+        QAction *action = transcriptUpdatesMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(intervalMs == HighlightTableWidget::FRAME_INTERVAL);
+        updateGroup->addAction(action);
+        connect(action, &QAction::triggered, this, [this, intervalMs = intervalMs]() {
+            highlightTableWidget->setUpdateInterval(intervalMs);
+        });
+    }
+    QAction *transcriptStatsAction = viewMenu->addAction("Transcript &statistics...");
+    connect(transcriptStatsAction, &QAction::triggered, this, &HyniWindow::showTranscriptStats);
+    QAction *speculationStatsAction = viewMenu->addAction("&Early answer statistics...");
+    connect(speculationStatsAction, &QAction::triggered, this, &HyniWindow::showSpeculationStats);
+    QAction *hedgeStatsAction = viewMenu->addAction("&Hedging statistics...");
+    connect(hedgeStatsAction, &QAction::triggered, this, &HyniWindow::showHedgeStats);
+    viewMenu->addSeparator();
+
+    // Pipeline latencies; recording is off until asked for
+    QAction *metricsPanelAction = m_metricsPanel->toggleViewAction();
+    metricsPanelAction->setText("&Metrics panel");
+    viewMenu->addAction(metricsPanelAction);
+
+    QAction *recordMetricsAction = viewMenu->addAction("&Record metrics");
+    recordMetricsAction->setCheckable(true);
+    recordMetricsAction->setChecked(MetricsRegistry::enabled());
+    connect(recordMetricsAction, &QAction::toggled, this, [](bool checked) {
+        MetricsRegistry::setEnabled(checked);
+    });
+    connect(m_metricsPanel, &MetricsPanel::recordingChanged, recordMetricsAction, &QAction::setChecked);
+
+    QAction *exportMetricsAction = viewMenu->addAction("E&xport metrics...");
+    connect(exportMetricsAction, &QAction::triggered, this, &HyniWindow::exportMetrics);
+
+    QAction *serveMetricsAction = viewMenu->addAction(
+        QString("Ser&ve metrics on localhost:%1").arg(MetricsExporter::DEFAULT_PORT));
+    serveMetricsAction->setCheckable(true);
+    connect(serveMetricsAction, &QAction::toggled, this, [this, serveMetricsAction, recordMetricsAction](bool checked) {
+        if (!checked) {
+            m_metricsExporter->stopListening();
+            return;
+        }
+        if (!m_metricsExporter->listen(MetricsExporter::DEFAULT_PORT)) {
+            statusBar()->showMessage("Cannot serve metrics: " + m_metricsExporter->errorString(), 5000);
+            QSignalBlocker blocker(serveMetricsAction);
+            serveMetricsAction->setChecked(false);
+            return;
+        }
+        recordMetricsAction->setChecked(true);
+        statusBar()->showMessage(QString("Serving metrics on http://127.0.0.1:%1/metrics")
+                                     .arg(MetricsExporter::DEFAULT_PORT), 3000);
+    });
 
     QMenu *helpMenu = menuBar->addMenu("&Help");
     QAction *aboutAction = helpMenu->addAction("&About");
@@ -470,7 +860,6 @@ void HyniWindow::setupMenuBar(QMenuBar* menuBar) {
 }
 
 void HyniWindow::onAISelectionChanged(QAction* action) {
-    hyni::chat_api::API_PROVIDER current = worker->getProvider();
     hyni::chat_api::API_PROVIDER newProvider;
     QString selectedAI = action->data().toString();
     if (selectedAI == "ChatGPT") {
@@ -480,9 +869,7 @@ void HyniWindow::onAISelectionChanged(QAction* action) {
         newProvider = hyni::chat_api::API_PROVIDER::DeepSeek;
     }
 
-    if (current != newProvider) {
-        worker->setProvider(newProvider);
-    }
+    m_core->setProvider(newProvider);
 
     // You could also update the status bar
     statusBar()->showMessage(selectedAI + " selected", 2000);
@@ -533,116 +920,108 @@ void HyniWindow::keyPressEvent(QKeyEvent* event) {
         sendText();
         break;
     case Qt::Key_P:            // Screenshot
-        QTimer::singleShot(3000, this, &HyniWindow::captureScreen);
+        captureScreen();
         break;
     default:
         QMainWindow::keyPressEvent(event);
     }
 }
 
+hyni::chat_api::QUESTION_TYPE HyniWindow::currentQuestionType() const {
+    if (generalOption->isChecked()) {
+        return hyni::chat_api::QUESTION_TYPE::General;
+    } else if (amazonStarOption->isChecked()) {
+        return hyni::chat_api::QUESTION_TYPE::Behavioral;
+    } else if (systemDesignOption->isChecked()) {
+        return hyni::chat_api::QUESTION_TYPE::SystemDesign;
+    }
+    return hyni::chat_api::QUESTION_TYPE::Coding;
+}
+
 void HyniWindow::captureScreen() {
 
-    if (worker->getProvider() == hyni::chat_api::API_PROVIDER::DeepSeek) {
+    if (!m_core->supportsImages()) {
         statusBar()->showMessage("Image is not supported in the selected provider.", 5000);
         return;
     }
 
-    QString savePath = "test.png";
-    QStringList args = {"-a", "-b", "--nonotify", "-o", savePath};
+    m_screenCapture->capture(m_captureOptions);
+}
 
-    QProcess spectacle;
-    spectacle.start("spectacle", args);
+void HyniWindow::handleScreenCaptured(const QImage& image, const CaptureTiming& timing) {
 
-    if (spectacle.waitForFinished(3000)) {  // Wait up to 3 seconds
-        if (!QFile::exists(savePath)) {
-            qDebug() << "Error: File not found at" << savePath;
-            return;
-        }
+    const QVector<HyniCore::Submission> submissions = m_core->askImage(image);
+    if (submissions.isEmpty()) {
+        return;
+    }
 
-        QPixmap pixmap;
-        if (!pixmap.load(savePath)) {
-            qDebug() << "Error: Failed to load image from" << savePath;
-            return;
-        }
+    metrics().screenGrab.record(std::chrono::milliseconds(timing.grabMs));
+    metrics().screenConvert.record(std::chrono::milliseconds(timing.convertMs));
+    trackSubmissions(submissions);
 
-        responseEditors.front()->setPlainText("Processing...");
-        QApplication::processEvents();
+    const auto* backend = qobject_cast<ScreenCaptureBackend*>(sender());
+    qDebug() << "Screenshot" << image.size() << "via" << (backend ? backend->name() : QString())
+             << "delay" << timing.delayMs << "ms, grab" << timing.grabMs
+             << "ms, convert" << timing.convertMs << "ms, total" << timing.totalMs << "ms";
+    statusBar()->showMessage(QString("Screenshot sent (grab %1 ms, convert %2 ms)")
+                                 .arg(timing.grabMs).arg(timing.convertMs), 3000);
+}
 
-        hyni::chat_api::QUESTION_TYPE qType;
+void HyniWindow::handleScreenCaptureFailed(const QString& error) {
 
-        if (generalOption->isChecked()) {
-            qType = hyni::chat_api::QUESTION_TYPE::General;
-        } else if (amazonStarOption->isChecked()) {
-            qType = hyni::chat_api::QUESTION_TYPE::Behavioral;
-        } else if (systemDesignOption->isChecked()) {
-            qType = hyni::chat_api::QUESTION_TYPE::SystemDesign;
-        } else {
-            qType = hyni::chat_api::QUESTION_TYPE::Coding;
-        }
+    qDebug() << "Screen capture failed:" << error;
 
-        QMetaObject::invokeMethod(worker, "sendImageRequest",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(QPixmap, pixmap),
-                                  tabWidget->tabText(0).remove('&'),
-                                  Q_ARG(hyni::chat_api::QUESTION_TYPE, qType));
+    // The delay has already passed, the fallback grabs right away
+    if (sender() == m_screenCapture && m_fallbackCapture) {
+        CaptureOptions options = m_captureOptions;
+        options.delayMs = 0;
+        m_fallbackCapture->capture(options);
+        return;
     }
+    statusBar()->showMessage("Screenshot failed: " + error, 5000);
 }
 
-void HyniWindow::handleCapturedScreen(const QPixmap& pixmap) {
+void HyniWindow::setScreenCaptureRegion() {
 
-    if (worker->getProvider() == hyni::chat_api::API_PROVIDER::DeepSeek) {
-        statusBar()->showMessage("Image is not supported in the selected provider.", 5000);
+    const QRect region = m_captureOptions.region;
+    const QString current = region.isEmpty() ? QString()
+        : QString("%1,%2,%3,%4").arg(region.x()).arg(region.y()).arg(region.width()).arg(region.height());
+
+    bool ok = false;
+    const QString text = QInputDialog::getText(this, "Screenshot region",
+                                               "x,y,width,height (empty for the whole screen):",
+                                               QLineEdit::Normal, current, &ok);
+    if (!ok) {
         return;
     }
 
-    responseEditors.front()->setPlainText("Processing...");
-    QApplication::processEvents();
-
-    hyni::chat_api::QUESTION_TYPE qType;
-
-    if (generalOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::General;
-    } else if (amazonStarOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::Behavioral;
-    } else if (systemDesignOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::SystemDesign;
-    } else {
-        qType = hyni::chat_api::QUESTION_TYPE::Coding;
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    if (parts.isEmpty()) {
+        m_captureOptions.region = QRect();
+        return;
     }
 
-    QMetaObject::invokeMethod(worker, "sendImageRequest",
-                              Qt::QueuedConnection,
-                              Q_ARG(QPixmap, pixmap),
-                              tabWidget->tabText(0).remove('&'),
-                              Q_ARG(hyni::chat_api::QUESTION_TYPE, qType));
-}
-
-void HyniWindow::resendCapturedScreen() {
-
-    if (worker->getProvider() == hyni::chat_api::API_PROVIDER::DeepSeek) {
-        statusBar()->showMessage("Image is not supported in the selected provider.", 5000);
+    QList<int> values;
+    for (const QString& part : parts) {
+        bool valid = false;
+        values.append(part.trimmed().toInt(&valid));
+        if (!valid) {
+            break;
+        }
+    }
+    if (values.size() != 4 || values[2] <= 0 || values[3] <= 0) {
+        statusBar()->showMessage("Invalid screenshot region: " + text, 5000);
         return;
     }
+    m_captureOptions.region = QRect(values[0], values[1], values[2], values[3]);
+}
 
-    responseEditors.front()->setPlainText("Processing...");
-    QApplication::processEvents();
-
-    hyni::chat_api::QUESTION_TYPE qType;
-
-    if (generalOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::General;
-    } else if (amazonStarOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::Behavioral;
-    } else if (systemDesignOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::SystemDesign;
-    } else {
-        qType = hyni::chat_api::QUESTION_TYPE::Coding;
-    }
+void HyniWindow::handleImageSubmitted(const QVector<HyniCore::Submission>& submissions) {
+    trackSubmissions(submissions);
+}
 
-    QMetaObject::invokeMethod(worker, "resendImageRequest",
-                              Qt::QueuedConnection,
-                              tabWidget->tabText(0).remove('&'),
-                              Q_ARG(hyni::chat_api::QUESTION_TYPE, qType));
+void HyniWindow::resendCapturedScreen() {
+    trackSubmissions(m_core->resendImage());
 }
 
 void HyniWindow::sendText(bool resend) {
@@ -652,59 +1031,14 @@ void HyniWindow::sendText(bool resend) {
     if (resend) {
         text = promptTextBox->toPlainText();
     } else {
-        highlightTableWidget->setRowCount(0);
+        highlightTableWidget->clearRow();
     }
 
     if (text.isEmpty()) return;
 
     promptTextBox->setText(text);
 
-    hyni::chat_api::QUESTION_TYPE qType;
-    QString enhancedPrompt;
-    bool multiLanguage = true;
-
-    // Set "Processing..." for relevant editors
-    if (generalOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::General;
-        multiLanguage = false;
-    }
-    else if (amazonStarOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::Behavioral;
-        multiLanguage = false;
-    }
-    else if (systemDesignOption->isChecked()) {
-        qType = hyni::chat_api::QUESTION_TYPE::SystemDesign;
-        enhancedPrompt = text;
-        enhancedPrompt += hyni::SYSTEM_DESIGN_EXT;
-        multiLanguage = false;
-    }
-    else { // Coding option
-        qType = hyni::chat_api::QUESTION_TYPE::Coding;
-        multiLanguage = true;
-    }
-
-    responseEditors.front()->setPlainText("Processing...");
-    QApplication::processEvents();
-
-    // Send requests
-    if (!multiLanguage) {
-        // For STAR and System Design (single response)
-        QMetaObject::invokeMethod(worker, "sendRequest",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(QString, enhancedPrompt),
-                                  Q_ARG(hyni::chat_api::QUESTION_TYPE, qType));
-    }
-    else {
-        // For Coding (language-specific responses)
-        QString langSpecificPrompt = text;
-        langSpecificPrompt += hyni::CODING_EXT;
-        langSpecificPrompt = langSpecificPrompt.arg(tabWidget->tabText(0).remove('&'));
-
-        QMetaObject::invokeMethod(worker, "sendRequest",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(QString, langSpecificPrompt),
-                                  Q_ARG(hyni::chat_api::QUESTION_TYPE, qType));
-    }
+    trackSubmissions(m_core->askText(text));
 }
 
 void HyniWindow::handleHighlightedText(const QString& texts) {
@@ -714,55 +1048,136 @@ void HyniWindow::handleHighlightedText(const QString& texts) {
 void HyniWindow::onWebSocketConnected(bool connected) {
     if (connected) {
         statusBar()->showMessage("Connected to wstream server.");
-        reconnectTimer->stop();
     } else {
         statusBar()->showMessage("Disconnected. Attempting to reconnect...");
-        reconnectTimer->start(3000); // Start trying to reconnect
     }
 }
 
-void HyniWindow::onWebSocketError(const std::string& error) {
-    statusBar()->showMessage(QString::fromStdString("WebSocket error: " + error));
+void HyniWindow::onWebSocketError(const QString& error) {
+    statusBar()->showMessage("WebSocket error: " + error);
 }
 
-void HyniWindow::attemptReconnect() {
-    if (!websocketClient->is_connected()) {
-        statusBar()->showMessage("Trying to reconnect...");
-        websocketClient->connect();
-    }
+#ifdef ENABLE_AUDIO_STREAM
+void HyniWindow::showAudioStats() {
+    const AudioStreamer::Stats capture = m_core->audioStreamer()->stats();
+    const VoiceActivityDetector::Stats vad = m_core->vadStats();
+    const TranscriptionClient::Stats transport = m_core->transcription()->stats();
+    const quint64 total = vad.framesSent + vad.framesSuppressed;
+
+    QString text = QString("<p>Frames captured: %1<br>"
+                           "Frames dropped (ring full): %2<br>"
+                           "Capture overruns: %3</p>"
+                           "<p>Frames sent: %4<br>"
+                           "Frames suppressed as silence: %5 (%6%)<br>"
+                           "Speech segments: %7</p>"
+                           "<p>Audio codec: %8<br>"
+                           "Bytes on the wire: %9 (%10:1 vs. PCM)</p>"
+                           "<p>Server messages: %11<br>"
+                           "Unknown: %12, malformed: %13, dropped: %14</p>"
+                           "<p>Reconnect attempts: %15<br>"
+                           "Audio messages replayed: %16, lost: %17</p>"
+                           "<p>Send queue: %18 audio, %19 control (peak %20 audio)<br>"
+                           "Dropped oldest: %21, dropped newest: %22<br>"
+                           "Capture paused: %23 times</p>")
+                       .arg(capture.framesCaptured)
+                       .arg(capture.framesDropped)
+                       .arg(capture.overruns)
+                       .arg(vad.framesSent)
+                       .arg(vad.framesSuppressed)
+                       .arg(total ? 100.0 * vad.framesSuppressed / total : 0.0, 0, 'f', 1)
+                       .arg(vad.speechSegments)
+                       .arg(audioCodecName(m_core->transcription()->audioCodec()))
+                       .arg(transport.audioBytes)
+                       .arg(transport.audioBytes ? double(transport.pcmBytes) / transport.audioBytes : 1.0, 0, 'f', 2)
+                       .arg(transport.messagesReceived)
+                       .arg(transport.messagesUnknown)
+                       .arg(transport.messagesMalformed)
+                       .arg(transport.messagesDropped)
+                       .arg(transport.reconnects)
+                       .arg(transport.audioReplayed)
+                       .arg(transport.audioLost)
+                       .arg(transport.audioQueueDepth)
+                       .arg(transport.controlQueueDepth)
+                       .arg(transport.audioQueueHighWater)
+                       .arg(transport.audioDroppedOldest)
+                       .arg(transport.audioDroppedNewest)
+                       .arg(transport.captureBlocks);
+
+    QMessageBox::information(this, "Audio Statistics", text);
 }
+#endif
 
-void HyniWindow::onMessageReceived(const std::string& message) {
-    qDebug() << "Message Received:" << QString::fromStdString(message);
-
-    try {
-        auto json = nlohmann::json::parse(message);
+void HyniWindow::exportMetrics() {
+    const QString path = QFileDialog::getSaveFileName(this, "Export Metrics", "qhyni.prom",
+                                                      "Prometheus text (*.prom);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
 
-        // Check the message type
-        if (json.contains("type")) {
-            std::string type = json["type"];
+    // Kept up to date from here on, for node_exporter's textfile collector
+    m_metricsExporter->setExportFile(path, METRICS_EXPORT_INTERVAL_MS);
+    if (!MetricsRegistry::enabled()) {
+        statusBar()->showMessage("Metrics exported - enable View > Record metrics to fill them", 5000);
+    } else {
+        statusBar()->showMessage("Metrics exported to " + path, 3000);
+    }
+}
 
-            if (type == "transcribe") {
-                // Handle transcribe messages
-                std::string content = json["content"];
-                qDebug() << "Transcribe Content:" << QString::fromStdString(content);
+void HyniWindow::showTranscriptStats() {
+    const HighlightTableWidget::UpdateStats updates = highlightTableWidget->updateStats();
+
+    QString text = QString("<p>Transcript messages: %1<br>"
+                           "Row layouts: %2<br>"
+                           "Layouts saved by batching: %3</p>"
+                           "<p>Layout time: %4 ms<br>"
+                           "Estimated time saved: %5 ms</p>")
+                       .arg(updates.fragments)
+                       .arg(updates.batches)
+                       .arg(updates.coalesced)
+                       .arg(updates.layoutNs / 1e6, 0, 'f', 1)
+                       .arg(updates.savedNs() / 1e6, 0, 'f', 1);
+
+    QMessageBox::information(this, "Transcript Statistics", text);
+}
 
-                // Add the transcribed text to the HighlightTableWidget
-                highlightTableWidget->addText(QString::fromStdString(content));
-            } else {
-                qDebug() << "Unknown message type received:" << QString::fromStdString(type);
-            }
-        } else {
-            qDebug() << "Message does not contain a 'type' field.";
-        }
-    } catch (const std::exception& e) {
-        qDebug() << "Invalid JSON message received:" << e.what();
-    }
+void HyniWindow::showSpeculationStats() {
+    const HyniCore::SpeculationStats stats = m_core->speculationStats();
+    const quint64 asked = stats.hits + stats.misses;
+
+    QString text = QString("<p>Asked early: %1<br>"
+                           "Claimed by Send: %2<br>"
+                           "Wasted: %3</p>"
+                           "<p>Sends answered early: %4 of %5 (%6%)<br>"
+                           "Head start: %7 ms on average, %8 ms in total</p>")
+                       .arg(stats.dispatched)
+                       .arg(stats.hits)
+                       .arg(stats.wasted)
+                       .arg(stats.hits)
+                       .arg(asked)
+                       .arg(asked ? 100.0 * stats.hits / asked : 0.0, 0, 'f', 1)
+                       .arg(stats.hits ? stats.savedNs / 1e6 / stats.hits : 0.0, 0, 'f', 0)
+                       .arg(stats.savedNs / 1e6, 0, 'f', 0);
+
+    QMessageBox::information(this, "Early Answer Statistics", text);
 }
 
-void HyniWindow::receiveAudioData(const QByteArray& data) {
-    std::vector<uint8_t> audioData(data.begin(), data.end());
-    websocketClient->sendAudioBuffer(audioData);
+void HyniWindow::showHedgeStats() {
+    const HyniCore::HedgeStats stats = m_core->hedgeStats();
+
+    QString text = QString("<p>Text questions watched: %1<br>"
+                           "Hedged: %2 (%3%)<br>"
+                           "Hedge delay now: %4 ms</p>"
+                           "<p>Other provider first: %5 (%6% of hedges)<br>"
+                           "Selected provider still first: %7</p>")
+                       .arg(stats.watched)
+                       .arg(stats.fired)
+                       .arg(stats.watched ? 100.0 * stats.fired / stats.watched : 0.0, 0, 'f', 1)
+                       .arg(m_core->hedgeDelayMs())
+                       .arg(stats.hedgeWins)
+                       .arg(stats.fired ? 100.0 * stats.hedgeWins / stats.fired : 0.0, 0, 'f', 1)
+                       .arg(stats.primaryWins);
+
+    QMessageBox::information(this, "Hedging Statistics", text);
 }
 
 void HyniWindow::showAboutDialog() {
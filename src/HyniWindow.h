@@ -11,15 +11,16 @@
 #include <QGroupBox>
 #include <QRadioButton>
 #include <QMap>
-#include <boost/asio.hpp>
-#include "PngMonitor.h"
-#include "websocket_client.h"
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include "HyniCore.h"
+#include "ScreenCapture.h"
 #include "HighlightTableWidget.h"
-#ifdef ENABLE_AUDIO_STREAM
-#include "AudioStreamer.h"
-#endif
 
-class ChatAPIWorker;
+class MetricsExporter;
+class MetricsPanel;
+class QActionGroup;
 
 class HyniWindow : public QMainWindow {
     Q_OBJECT
@@ -34,31 +35,48 @@ protected:
 private slots:
     void sendText(bool resend = false);
     void handleHighlightedText(const QString& texts);
-    void onMessageReceived(const std::string& message);
     void onWebSocketConnected(bool connected);
-    void onWebSocketError(const std::string& error);
-    void handleAPIResponse(const QString& response);
-    void handleAPIError(const QString& error);
+    void onWebSocketError(const QString& error);
+    void handleAPIPartialResponse(quint64 requestId, const QString& delta);
+    void handleAPIResponse(quint64 requestId, const QString& response, bool fromCache);
+    void handleAPIError(quint64 requestId, const QString& error);
+    void handleRequestFinished(quint64 requestId);
     void handleNeedAPIKey();
     void captureScreen();
-    void handleCapturedScreen(const QPixmap& pixmap);
+    void handleScreenCaptured(const QImage& image, const CaptureTiming& timing);
+    void handleScreenCaptureFailed(const QString& error);
+    void handleImageSubmitted(const QVector<HyniCore::Submission>& submissions);
     void resendCapturedScreen();
-    void receiveAudioData(const QByteArray& data);
     void onAISelectionChanged(QAction* action);
     void zoomInResponseBox();
     void zoomOutResponseBox();
     void showAboutDialog();
+    void showTranscriptStats();
+    void showSpeculationStats();
+    void showHedgeStats();
+    void exportMetrics();
     void onLanguageChanged(QAction* action);
+    void onMultiLanguageToggled(bool enabled);
 
 private:
-    void attemptReconnect();
-    void setupAPIWorkers();
-    void addResponseTab(const QString& language);
-    void cleanupAPIWorkers();
-    std::string sendToChatAPI(const QString& text, bool isStarQuestion);
+#ifdef ENABLE_AUDIO_STREAM
+    void showAudioStats();
+#endif
+    QTextEdit* addResponseTab(const QString& language, int index = -1);
+    bool removeResponseTab(const QString& language);
+    QVector<QTextEdit*> languageEditors() const;
+    QString languageOf(QTextEdit* editor) const;
+    void markUnanswered(quint64 requestId, const QString& marker);
+    QTextEdit* editorFor(const QString& language) const;
+    void syncLanguages();
+    void trackSubmissions(const QVector<HyniCore::Submission>& submissions);
+    void setScreenCaptureRegion();
+    hyni::chat_api::QUESTION_TYPE currentQuestionType() const;
     void toggleQuestionType();
     void handleTabNavigation(QKeyEvent* event);
     void setupMenuBar(QMenuBar* menuBar);
+    void flushStreamedText();
+    void appendToHistory(const QString& response);
 
     HighlightTableWidget* highlightTableWidget;
     QTextEdit* promptTextBox;
@@ -68,23 +86,32 @@ private:
     QRadioButton* codingOption;
     QString highlightedText;
     QTabWidget *tabWidget;
+    QActionGroup* m_langGroup;
+    QAction* m_multiLanguageAction;
 
-    QString m_sharedApiKey;
     bool m_apiKeyRequested{false};
 
-    QVector<QTextEdit*> responseEditors;
-    ChatAPIWorker* worker;
-    QThread* thread;
+    // An in-flight request and the editor its answer goes to
+    struct PendingResponse {
+        QPointer<QTextEdit> editor;
+        QString streamText;
+        bool started{false};
+        bool answered{false};  // an answer or an error was shown
+    };
 
-    std::unique_ptr<QTimer> reconnectTimer;
-    std::unique_ptr<boost::asio::io_context> io_context;
-    std::shared_ptr<hyni_websocket_client> websocketClient;
-    std::thread io_thread;
+    QVector<QTextEdit*> responseEditors;
+    QHash<quint64, PendingResponse> m_pendingResponses;
+    QHash<QTextEdit*, quint64> m_editorOwners;
+    QTimer* m_streamFlushTimer;
+    HyniCore* m_core{nullptr};
 
-    PngMonitor m_png_monitor;
-    QVector<QString> m_history;
+    MetricsPanel* m_metricsPanel{nullptr};
+    MetricsExporter* m_metricsExporter{nullptr};
+    ScreenCaptureBackend* m_screenCapture{nullptr};
+    ScreenCaptureBackend* m_fallbackCapture{nullptr};
+    CaptureOptions m_captureOptions;
 #ifdef ENABLE_AUDIO_STREAM
-    AudioStreamer m_streamer;
+    QAction* m_vadAction{nullptr};
 #endif
 };
 
@@ -0,0 +1,153 @@
+#include "ImageEncoder.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImageWriter>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+// Samples per axis when guessing whether an image is a screenshot
+constexpr int CONTENT_SAMPLE_GRID = 64;
+
+// Lossy qualities tried, in order, while the output is over budget
+constexpr int FALLBACK_QUALITIES[] = {70, 55};
+
+// Never shrink below this width while enforcing the byte budget; text
+// becomes illegible for the model long before that.
+constexpr int MIN_BUDGET_WIDTH = 960;
+
+QByteArray saveImage(const QImage& image, const char* format, int quality) {
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+
+    if (!image.save(&buffer, format, quality)) {
+        return QByteArray();
+    }
+    return bytes;
+}
+
+QByteArray mimeTypeFor(const QByteArray& format) {
+    if (format == "JPEG") {
+        return "image/jpeg";
+    } else if (format == "WEBP") {
+        return "image/webp";
+    }
+    return "image/png";
+}
+
+} // namespace
+
+ImageEncodeProfile ImageEncodeProfile::forQuestionType(hyni::chat_api::QUESTION_TYPE type) {
+    ImageEncodeProfile profile;
+
+    switch (type) {
+    case hyni::chat_api::QUESTION_TYPE::Coding:
+        // Mostly text; keep it lossless unless it really doesn't fit
+        profile.byteBudget = 1536 * 1024;
+        break;
+    case hyni::chat_api::QUESTION_TYPE::SystemDesign:
+        // Diagrams with small labels
+        profile.byteBudget = 2048 * 1024;
+        break;
+    default:
+        profile.byteBudget = 1024 * 1024;
+        profile.lossyQuality = 80;
+        break;
+    }
+    return profile;
+}
+
+EncodedImage ImageEncoder::encode(const QImage& image, const ImageEncodeProfile& profile) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QImage scaled = image;
+    if (profile.maxLongEdge > 0 &&
+        std::max(image.width(), image.height()) > profile.maxLongEdge) {
+        scaled = image.scaled(profile.maxLongEdge, profile.maxLongEdge,
+                              Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    // Screenshots are opaque, and JPEG can't carry alpha anyway
+    if (scaled.format() != QImage::Format_RGB32) {
+        scaled = scaled.convertToFormat(QImage::Format_RGB32);
+    }
+
+    const auto fits = [&profile](const QByteArray& bytes) {
+        return profile.byteBudget <= 0 || bytes.size() <= profile.byteBudget;
+    };
+
+    const QByteArray lossyFormat = supportsWebP() ? "WEBP" : "JPEG";
+    QByteArray format;
+    QByteArray bytes;
+
+    if (!profile.allowLossy || looksLikeScreenshot(scaled)) {
+        format = "PNG";
+        bytes = saveImage(scaled, format.constData(), -1);
+    }
+
+    if (profile.allowLossy && (bytes.isEmpty() || !fits(bytes))) {
+        format = lossyFormat;
+        bytes = saveImage(scaled, format.constData(), profile.lossyQuality);
+
+        for (int quality : FALLBACK_QUALITIES) {
+            if (fits(bytes)) {
+                break;
+            }
+            if (quality < profile.lossyQuality) {
+                bytes = saveImage(scaled, format.constData(), quality);
+            }
+        }
+    }
+
+    // Still over budget: trade resolution for size
+    while (!bytes.isEmpty() && !fits(bytes) && scaled.width() * 3 / 4 >= MIN_BUDGET_WIDTH) {
+        scaled = scaled.scaled(scaled.width() * 3 / 4, scaled.height() * 3 / 4,
+                               Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        const int quality = format == "PNG" ? -1 : FALLBACK_QUALITIES[std::size(FALLBACK_QUALITIES) - 1];
+        bytes = saveImage(scaled, format.constData(), quality);
+    }
+
+    if (bytes.isEmpty()) {
+        throw std::runtime_error("Failed to encode the screenshot.");
+    }
+
+    EncodedImage encoded;
+    encoded.encodedBytes = bytes.size();
+    encoded.base64 = bytes.toBase64();
+    encoded.mimeType = mimeTypeFor(format);
+    encoded.size = scaled.size();
+    encoded.encodeMicros = timer.nsecsElapsed() / 1000;
+    return encoded;
+}
+
+bool ImageEncoder::looksLikeScreenshot(const QImage& image) {
+    if (image.isNull()) {
+        return true;
+    }
+
+    const int stepX = std::max(1, image.width() / CONTENT_SAMPLE_GRID);
+    const int stepY = std::max(1, image.height() / CONTENT_SAMPLE_GRID);
+
+    QSet<QRgb> colors;
+    int samples = 0;
+    for (int y = 0; y < image.height(); y += stepY) {
+        for (int x = 0; x < image.width(); x += stepX) {
+            colors.insert(image.pixel(x, y) & 0x00ffffff);
+            ++samples;
+        }
+    }
+
+    // UI, code and diagrams repeat a handful of exact colours; photos and
+    // gradients almost never hit the same value twice.
+    return colors.size() * 10 < samples * 3;
+}
+
+bool ImageEncoder::supportsWebP() {
+    static const bool supported = QImageWriter::supportedImageFormats().contains("webp");
+    return supported;
+}
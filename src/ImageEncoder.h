@@ -0,0 +1,41 @@
+#ifndef IMAGE_ENCODER_H
+#define IMAGE_ENCODER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include "chat_api.h"
+
+// How a screenshot is prepared for upload. The vision models downscale
+// anything larger than 2048 px on the long edge themselves, so sending more
+// than that only costs upload time.
+struct ImageEncodeProfile {
+    int maxLongEdge{2048};      // 0 keeps the original resolution
+    qint64 byteBudget{0};       // encoded bytes before base64, 0 = unlimited
+    bool allowLossy{true};      // JPEG/WebP may be used
+    int lossyQuality{85};
+
+    static ImageEncodeProfile forQuestionType(hyni::chat_api::QUESTION_TYPE type);
+};
+
+struct EncodedImage {
+    QByteArray base64;
+    QByteArray mimeType;
+    QSize size;
+    qint64 encodedBytes{0};
+    qint64 encodeMicros{0};
+};
+
+class ImageEncoder
+{
+public:
+    static EncodedImage encode(const QImage& image, const ImageEncodeProfile& profile);
+
+    // True for flat content (text, code, diagrams) that PNG compresses well
+    // and lossy codecs blur; false for photos and gradients.
+    static bool looksLikeScreenshot(const QImage& image);
+
+    static bool supportsWebP();
+};
+
+#endif // IMAGE_ENCODER_H
@@ -0,0 +1,204 @@
+#include "Metrics.h"
+#include <bit>
+#include <cstdio>
+
+std::atomic<bool> MetricsRegistry::s_enabled{false};
+
+int LatencyHistogram::bucketIndex(std::uint64_t nanos)
+{
+    if (nanos < SUB_BUCKETS) {
+        return int(nanos);
+    }
+    nanos = std::min(nanos, MAX_NANOS);
+    // The top SUB_BUCKET_BITS + 1 bits select the bucket
+    const int magnitude = std::bit_width(nanos) - 1;
+    const int shift = magnitude - SUB_BUCKET_BITS;
+    const int subBucket = int(nanos >> shift) - SUB_BUCKETS;
+    return (shift + 1) * SUB_BUCKETS + subBucket;
+}
+
+std::uint64_t LatencyHistogram::bucketMidpoint(int index)
+{
+    if (index < SUB_BUCKETS) {
+        return std::uint64_t(index);
+    }
+    const int shift = index / SUB_BUCKETS - 1;
+    const std::uint64_t lower = std::uint64_t(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    return lower + ((std::uint64_t(1) << shift) >> 1);
+}
+
+void LatencyHistogram::recordNanos(std::uint64_t nanos)
+{
+    m_buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanos, std::memory_order_relaxed);
+
+    std::uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (nanos > max && !m_max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    // Not atomic as a whole; count is taken from the buckets so quantiles
+    // stay consistent with them.
+    Snapshot snapshot;
+    snapshot.buckets.resize(BUCKETS);
+    for (int i = 0; i < BUCKETS; ++i) {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sumNanos = m_sum.load(std::memory_order_relaxed);
+    snapshot.maxNanos = m_max.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::Snapshot::quantile(double q) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    const std::uint64_t rank = std::max<std::uint64_t>(1, std::uint64_t(std::clamp(q, 0.0, 1.0) * double(count) + 0.5));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < int(buckets.size()); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // The midpoint may lie above anything actually recorded
+            return std::min(bucketMidpoint(i), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+MetricsRegistry& MetricsRegistry::global()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+const MetricsRegistry::Metric* MetricsRegistry::find(const std::string& name) const
+{
+    for (const Metric& metric : m_metrics) {
+        if (metric.name == name) {
+            return &metric;
+        }
+    }
+    return nullptr;
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (const Metric* existing = find(name)) {
+        return *static_cast<MetricCounter*>(existing->metric);
+    }
+    MetricCounter& counter = m_counters.emplace_back();
+    m_metrics.push_back(Metric{name, help, Type::Counter, &counter});
+    return counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (const Metric* existing = find(name)) {
+        return *static_cast<MetricGauge*>(existing->metric);
+    }
+    MetricGauge& gauge = m_gauges.emplace_back();
+    m_metrics.push_back(Metric{name, help, Type::Gauge, &gauge});
+    return gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (const Metric* existing = find(name)) {
+        return *static_cast<LatencyHistogram*>(existing->metric);
+    }
+    LatencyHistogram& histogram = m_histograms.emplace_back();
+    m_metrics.push_back(Metric{name, help, Type::Histogram, &histogram});
+    return histogram;
+}
+
+std::vector<MetricsRegistry::Entry> MetricsRegistry::entries() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Entry> entries;
+    entries.reserve(m_metrics.size());
+    for (const Metric& metric : m_metrics) {
+        Entry entry;
+        entry.name = metric.name;
+        entry.help = metric.help;
+        entry.type = metric.type;
+        switch (metric.type) {
+        case Type::Counter:
+            entry.value = double(static_cast<const MetricCounter*>(metric.metric)->value());
+            break;
+        case Type::Gauge:
+            entry.value = double(static_cast<const MetricGauge*>(metric.metric)->value());
+            break;
+        case Type::Histogram:
+            entry.histogram = static_cast<const LatencyHistogram*>(metric.metric)->snapshot();
+            break;
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+void MetricsRegistry::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (MetricCounter& counter : m_counters) {
+        counter.m_value.store(0, std::memory_order_relaxed);
+    }
+    for (LatencyHistogram& histogram : m_histograms) {
+        histogram.reset();
+    }
+    // Gauges describe the present, they are left alone
+}
+
+std::string MetricsRegistry::toPrometheus() const
+{
+    static constexpr double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+    std::string text;
+    char line[256];
+    for (const Entry& entry : entries()) {
+        const char* type = entry.type == Type::Counter ? "counter"
+                         : entry.type == Type::Gauge   ? "gauge"
+                                                       : "summary";
+        text += "# HELP " + entry.name + " " + entry.help + "\n";
+        text += "# TYPE " + entry.name + " " + type + "\n";
+
+        if (entry.type != Type::Histogram) {
+            std::snprintf(line, sizeof(line), "%s %.17g\n", entry.name.c_str(), entry.value);
+            text += line;
+            continue;
+        }
+
+        const LatencyHistogram::Snapshot& histogram = entry.histogram;
+        for (double q : QUANTILES) {
+            std::snprintf(line, sizeof(line), "%s{quantile=\"%g\"} %.9f\n", entry.name.c_str(), q,
+                          double(histogram.quantile(q)) / 1e9);
+            text += line;
+        }
+        std::snprintf(line, sizeof(line), "%s_sum %.9f\n%s_count %llu\n", entry.name.c_str(),
+                      double(histogram.sumNanos) / 1e9, entry.name.c_str(),
+                      static_cast<unsigned long long>(histogram.count));
+        text += line;
+    }
+    return text;
+}
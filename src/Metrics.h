@@ -0,0 +1,203 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Process-wide counters, gauges and latency histograms for the
+// question -> answer pipeline and the audio path.
+//
+// Metrics are registered once, usually into a function-local static at the
+// place they are recorded, and live as long as the process. Recording is
+// lock-free and safe from any thread. While recording is disabled (the
+// default) every record call is a single relaxed load and a branch, and
+// ScopedLatency does not even read the clock. Gauges are the exception:
+// they are always set, so they are right the moment recording starts.
+class MetricsRegistry;
+
+class MetricCounter
+{
+public:
+    void add(std::uint64_t n = 1);
+    std::uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    friend class MetricsRegistry;
+    std::atomic<std::uint64_t> m_value{0};
+};
+
+class MetricGauge
+{
+public:
+    void set(std::int64_t value);
+    void add(std::int64_t delta);
+    std::int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    friend class MetricsRegistry;
+    std::atomic<std::int64_t> m_value{0};
+};
+
+// Log-linear buckets in the manner of HdrHistogram: every power of two is
+// split into SUB_BUCKETS linear buckets, so any recorded value is known to
+// within about 2% up to MAX_NANOS.
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_MAGNITUDE = 40;  // 2^40 ns, about 18 minutes
+    static constexpr std::uint64_t MAX_NANOS = (std::uint64_t(1) << MAX_MAGNITUDE) - 1;
+    static constexpr int BUCKETS = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot {
+        std::uint64_t count{0};
+        std::uint64_t sumNanos{0};
+        std::uint64_t maxNanos{0};
+        std::vector<std::uint64_t> buckets;
+
+        // Value at quantile q (0..1), in ns
+        std::uint64_t quantile(double q) const;
+        double meanNanos() const { return count ? double(sumNanos) / double(count) : 0.0; }
+    };
+
+    void record(std::chrono::nanoseconds elapsed);
+    void recordNanos(std::uint64_t nanos);
+    Snapshot snapshot() const;
+
+    static int bucketIndex(std::uint64_t nanos);
+    static std::uint64_t bucketMidpoint(int index);
+
+private:
+    friend class MetricsRegistry;
+    void reset();
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> m_buckets{};
+    std::atomic<std::uint64_t> m_sum{0};
+    std::atomic<std::uint64_t> m_max{0};
+};
+
+// Records the lifetime of the object into a histogram
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram);
+    ~ScopedLatency();
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* m_histogram;  // null while disabled
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Calls fn() and records how long it took
+template <typename Fn>
+decltype(auto) timed(LatencyHistogram& histogram, Fn&& fn)
+{
+    ScopedLatency latency(histogram);
+    return fn();
+}
+
+class MetricsRegistry
+{
+public:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Entry {
+        std::string name;  // Prometheus style, e.g. qhyni_image_encode_seconds
+        std::string help;
+        Type type{Type::Counter};
+        double value{0};   // counters and gauges
+        LatencyHistogram::Snapshot histogram;
+    };
+
+    static MetricsRegistry& global();
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    // Registering a name twice returns the first metric
+    MetricCounter& counter(const std::string& name, const std::string& help);
+    MetricGauge& gauge(const std::string& name, const std::string& help);
+    LatencyHistogram& histogram(const std::string& name, const std::string& help);
+
+    // In registration order
+    std::vector<Entry> entries() const;
+    void reset();
+
+    // Text exposition format; histograms are exported as summaries in
+    // seconds with their 0.5, 0.9, 0.99 and 0.999 quantiles.
+    std::string toPrometheus() const;
+
+private:
+    MetricsRegistry() = default;
+
+    struct Metric {
+        std::string name;
+        std::string help;
+        Type type;
+        void* metric;
+    };
+
+    const Metric* find(const std::string& name) const;
+
+    static std::atomic<bool> s_enabled;
+
+    mutable std::mutex m_mutex;
+    std::vector<Metric> m_metrics;
+    // deque, so references handed out stay valid
+    std::deque<MetricCounter> m_counters;
+    std::deque<MetricGauge> m_gauges;
+    std::deque<LatencyHistogram> m_histograms;
+};
+
+inline void MetricCounter::add(std::uint64_t n)
+{
+    if (MetricsRegistry::enabled()) {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+inline void MetricGauge::set(std::int64_t value)
+{
+    m_value.store(value, std::memory_order_relaxed);
+}
+
+inline void MetricGauge::add(std::int64_t delta)
+{
+    m_value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+inline void LatencyHistogram::record(std::chrono::nanoseconds elapsed)
+{
+    if (MetricsRegistry::enabled()) {
+        recordNanos(std::uint64_t(std::max<std::int64_t>(0, elapsed.count())));
+    }
+}
+
+inline ScopedLatency::ScopedLatency(LatencyHistogram& histogram)
+    : m_histogram(MetricsRegistry::enabled() ? &histogram : nullptr)
+{
+    if (m_histogram) {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+inline ScopedLatency::~ScopedLatency()
+{
+    if (m_histogram) {
+        m_histogram->recordNanos(std::uint64_t(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count()));
+    }
+}
+
+#endif // METRICS_H
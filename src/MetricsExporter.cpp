@@ -0,0 +1,135 @@
+#include "MetricsExporter.h"
+#include "Metrics.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+
+// Anything larger is not a scrape request
+constexpr qsizetype MAX_REQUEST_BYTES = 8192;
+
+QByteArray httpResponse(const QByteArray& status, const QByteArray& contentType, const QByteArray& body) {
+    return "HTTP/1.1 " + status + "\r\n"
+           "Content-Type: " + contentType + "\r\n"
+           "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+           "Connection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(QObject* parent)
+    : QObject(parent)
+{
+    connect(&m_exportTimer, &QTimer::timeout, this, &MetricsExporter::writeExportFile);
+}
+
+bool MetricsExporter::writeFile(const QString& path, QString* error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    file.write(QByteArray::fromStdString(MetricsRegistry::global().toPrometheus()));
+    if (!file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::setExportFile(const QString& path, int intervalMs)
+{
+    m_exportPath = path;
+    m_exportTimer.stop();
+    if (path.isEmpty()) {
+        return;
+    }
+
+    writeExportFile();
+    if (intervalMs > 0) {
+        m_exportTimer.start(intervalMs);
+    }
+}
+
+QString MetricsExporter::exportFile() const
+{
+    return m_exportPath;
+}
+
+void MetricsExporter::writeExportFile()
+{
+    QString error;
+    if (!writeFile(m_exportPath, &error)) {
+        qWarning() << "Failed to export metrics to" << m_exportPath << error;
+    }
+}
+
+bool MetricsExporter::listen(quint16 port)
+{
+    stopListening();
+
+    m_server = new QTcpServer(this);
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        m_error = m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        return false;
+    }
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::acceptConnections);
+    m_error.clear();
+    return true;
+}
+
+void MetricsExporter::stopListening()
+{
+    if (m_server) {
+        m_server->close();
+        m_server->deleteLater();
+        m_server = nullptr;
+    }
+}
+
+bool MetricsExporter::isListening() const
+{
+    return m_server && m_server->isListening();
+}
+
+QString MetricsExporter::errorString() const
+{
+    return m_error;
+}
+
+void MetricsExporter::acceptConnections()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+            // Only the request line matters; wait until the headers are in
+            const QByteArray request = socket->peek(MAX_REQUEST_BYTES);
+            if (!request.contains("\r\n\r\n") && request.size() < MAX_REQUEST_BYTES) {
+                return;
+            }
+            socket->readAll();
+
+            const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+            const QByteArray path = requestLine.size() >= 2 ? requestLine.at(1) : QByteArray();
+            if (requestLine.value(0) != "GET") {
+                socket->write(httpResponse("405 Method Not Allowed", "text/plain", "GET only\n"));
+            } else if (path == "/metrics" || path == "/") {
+                socket->write(httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                           QByteArray::fromStdString(MetricsRegistry::global().toPrometheus())));
+            } else {
+                socket->write(httpResponse("404 Not Found", "text/plain", "Try /metrics\n"));
+            }
+            socket->disconnectFromHost();
+        });
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class QTcpServer;
+
+// Publishes MetricsRegistry::global() in the Prometheus text format, either
+// as a file rewritten periodically (for node_exporter's textfile collector)
+// or over HTTP on localhost for a Prometheus server to scrape.
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT = 9464;
+
+    explicit MetricsExporter(QObject* parent = nullptr);
+
+    // Written atomically, so readers never see half a file
+    static bool writeFile(const QString& path, QString* error = nullptr);
+
+    // intervalMs 0 writes once and stops any periodic export
+    void setExportFile(const QString& path, int intervalMs);
+    QString exportFile() const;
+
+    // Serves GET /metrics (and /) on 127.0.0.1 only
+    bool listen(quint16 port = DEFAULT_PORT);
+    void stopListening();
+    bool isListening() const;
+    QString errorString() const;
+
+private slots:
+    void acceptConnections();
+    void writeExportFile();
+
+private:
+    QTcpServer* m_server{nullptr};
+    QString m_exportPath;
+    QTimer m_exportTimer;
+    QString m_error;
+};
+
+#endif // METRICS_EXPORTER_H
@@ -0,0 +1,113 @@
+#include "MetricsPanel.h"
+#include "Metrics.h"
+#include <QCheckBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Column { NameColumn, CountColumn, MeanColumn, P50Column, P90Column, P99Column, MaxColumn, ColumnCount };
+
+QString millis(double nanos) {
+    return QString::number(nanos / 1e6, 'f', nanos < 1e7 ? 3 : 1);
+}
+
+} // namespace
+
+MetricsPanel::MetricsPanel(QWidget* parent)
+    : QDockWidget("Metrics", parent)
+{
+    setObjectName("MetricsPanel");
+
+    QWidget* content = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(content);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    m_recordBox = new QCheckBox("&Record", content);
+    m_recordBox->setChecked(MetricsRegistry::enabled());
+    m_recordBox->setToolTip("Metrics cost next to nothing while not recorded");
+    QPushButton* resetButton = new QPushButton("Rese&t", content);
+    controls->addWidget(m_recordBox);
+    controls->addStretch();
+    controls->addWidget(resetButton);
+    layout->addLayout(controls);
+
+    m_table = new QTableWidget(0, ColumnCount, content);
+    m_table->setHorizontalHeaderLabels({"Metric", "Count / value", "Mean ms", "p50 ms", "p90 ms", "p99 ms", "Max ms"});
+    m_table->horizontalHeader()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->setFocusPolicy(Qt::NoFocus);
+    layout->addWidget(m_table);
+
+    setWidget(content);
+
+    connect(m_recordBox, &QCheckBox::toggled, this, [this](bool checked) {
+        MetricsRegistry::setEnabled(checked);
+        emit recordingChanged(checked);
+    });
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        MetricsRegistry::global().reset();
+        refresh();
+    });
+    connect(&m_refreshTimer, &QTimer::timeout, this, &MetricsPanel::refresh);
+}
+
+void MetricsPanel::showEvent(QShowEvent* event)
+{
+    QDockWidget::showEvent(event);
+    m_recordBox->setChecked(MetricsRegistry::enabled());
+    refresh();
+    m_refreshTimer.start(REFRESH_INTERVAL_MS);
+}
+
+void MetricsPanel::hideEvent(QHideEvent* event)
+{
+    QDockWidget::hideEvent(event);
+    m_refreshTimer.stop();
+}
+
+void MetricsPanel::refresh()
+{
+    const std::vector<MetricsRegistry::Entry> entries = MetricsRegistry::global().entries();
+    m_table->setRowCount(int(entries.size()));
+
+    int row = 0;
+    for (const MetricsRegistry::Entry& entry : entries) {
+        QStringList cells(ColumnCount);
+        cells[NameColumn] = QString::fromStdString(entry.name);
+        if (entry.type == MetricsRegistry::Type::Histogram) {
+            const LatencyHistogram::Snapshot& histogram = entry.histogram;
+            cells[CountColumn] = QString::number(histogram.count);
+            if (histogram.count > 0) {
+                cells[MeanColumn] = millis(histogram.meanNanos());
+                cells[P50Column] = millis(double(histogram.quantile(0.5)));
+                cells[P90Column] = millis(double(histogram.quantile(0.9)));
+                cells[P99Column] = millis(double(histogram.quantile(0.99)));
+                cells[MaxColumn] = millis(double(histogram.maxNanos));
+            }
+        } else {
+            cells[CountColumn] = QString::number(qint64(entry.value));
+        }
+
+        for (int column = 0; column < ColumnCount; ++column) {
+            QTableWidgetItem* item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column != NameColumn) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_table->setItem(row, column, item);
+            }
+            if (item->text() != cells[column]) {
+                item->setText(cells[column]);
+            }
+        }
+        m_table->item(row, NameColumn)->setToolTip(QString::fromStdString(entry.help));
+        ++row;
+    }
+}
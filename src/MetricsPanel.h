@@ -0,0 +1,38 @@
+#ifndef METRICS_PANEL_H
+#define METRICS_PANEL_H
+
+#include <QDockWidget>
+#include <QTimer>
+
+class QCheckBox;
+class QTableWidget;
+
+// Dockable live view of MetricsRegistry::global(): counters and gauges with
+// their value, latency histograms with count, mean and quantiles in ms.
+// Only refreshes while visible.
+class MetricsPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int REFRESH_INTERVAL_MS = 1000;
+
+    explicit MetricsPanel(QWidget* parent = nullptr);
+
+public slots:
+    void refresh();
+
+signals:
+    void recordingChanged(bool enabled);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    QTableWidget* m_table;
+    QCheckBox* m_recordBox;
+    QTimer m_refreshTimer;
+};
+
+#endif // METRICS_PANEL_H
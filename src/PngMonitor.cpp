@@ -0,0 +1,225 @@
+#include "PngMonitor.h"
+#include "Metrics.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSocketNotifier>
+#include <QThread>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+// Only used when the folder cannot be watched
+constexpr int POLL_INTERVAL_MS = 2500;
+
+constexpr int MAX_DECODE_THREADS = 4;
+
+bool isPng(const QString& fileName) {
+    return fileName.endsWith(".png", Qt::CaseInsensitive);
+}
+}
+
+PngMonitor::PngMonitor(const QString &folderPath, QObject *parent)
+    : QObject(parent), m_folderPath(folderPath)
+{
+    m_decodePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), MAX_DECODE_THREADS));
+
+    connect(&m_pollTimer, &QTimer::timeout, this, &PngMonitor::checkForNewPngs);
+    m_pollTimer.setInterval(POLL_INTERVAL_MS);
+    m_pollTimer.setSingleShot(false);
+
+    if (!startWatching()) {
+        qDebug() << "Polling" << m_folderPath << "for screenshots";
+        m_retryWatch = !QFileInfo(m_folderPath).isDir();
+        m_pollTimer.start();
+    }
+
+    // Screenshots that arrived while the app was not running are complete
+    scanFolder(false);
+}
+
+PngMonitor::~PngMonitor()
+{
+    stopWatching();
+    m_decodePool.waitForDone();
+}
+
+bool PngMonitor::startWatching()
+{
+#ifdef Q_OS_LINUX
+    m_watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_watchFd < 0) {
+        qWarning() << "inotify unavailable:" << strerror(errno);
+        return false;
+    }
+
+    // CLOSE_WRITE for files written in place, MOVED_TO for sync clients
+    // that write to a temporary name and rename when done.
+    const QByteArray path = QFile::encodeName(m_folderPath);
+    if (inotify_add_watch(m_watchFd, path.constData(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+        qWarning() << "Cannot watch" << m_folderPath << ":" << strerror(errno);
+        stopWatching();
+        return false;
+    }
+
+    m_watchNotifier = new QSocketNotifier(m_watchFd, QSocketNotifier::Read, this);
+    connect(m_watchNotifier, &QSocketNotifier::activated, this, &PngMonitor::readWatchEvents);
+    qDebug() << "Watching" << m_folderPath << "for screenshots";
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PngMonitor::stopWatching()
+{
+#ifdef Q_OS_LINUX
+    delete m_watchNotifier;
+    m_watchNotifier = nullptr;
+    if (m_watchFd >= 0) {
+        ::close(m_watchFd);
+        m_watchFd = -1;
+    }
+#endif
+}
+
+void PngMonitor::readWatchEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[4096];
+    bool rescan = false;
+    bool folderGone = false;
+
+    for (;;) {
+        const ssize_t length = ::read(m_watchFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += ssize_t(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescan = true;
+            } else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                folderGone = true;
+            } else if (event->len > 0) {
+                const QString name = QFile::decodeName(event->name);
+                if (isPng(name)) {
+                    const QString path = QDir(m_folderPath).absoluteFilePath(name);
+                    m_failed.remove(path);
+                    decode(path);
+                }
+            }
+        }
+    }
+
+    if (folderGone) {
+        // Keep looking in case the folder is recreated
+        qWarning() << m_folderPath << "disappeared, falling back to polling";
+        stopWatching();
+        m_retryWatch = true;
+        m_pollTimer.start();
+    } else if (rescan) {
+        scanFolder(false);
+    }
+#endif
+}
+
+void PngMonitor::checkForNewPngs()
+{
+    if (m_retryWatch && QFileInfo(m_folderPath).isDir()) {
+        m_retryWatch = false;
+        startWatching();
+    }
+
+    scanFolder(true);
+
+    // Files seen growing before the watch started are still polled for,
+    // they may have been closed before it could see them
+    if (m_watchFd >= 0 && m_seenSizes.isEmpty()) {
+        m_pollTimer.stop();
+    }
+}
+
+void PngMonitor::scanFolder(bool requireStableSize)
+{
+    QDir dir(m_folderPath);
+    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.png", QDir::Files);
+
+    QHash<QString, qint64> sizes;
+    for (const QFileInfo& file : files) {
+        const QString path = file.absoluteFilePath();
+        const auto failed = m_failed.find(path);
+        if (failed != m_failed.end()) {
+            // Retried once it was written again
+            if (failed.value() == FileStamp{file.size(), file.lastModified()}) {
+                continue;
+            }
+            m_failed.erase(failed);
+        }
+
+        // While polling, a file still growing is still being written
+        if (requireStableSize && m_seenSizes.value(path, -1) != file.size()) {
+            sizes.insert(path, file.size());
+            continue;
+        }
+        decode(path);
+    }
+    m_seenSizes = sizes;
+}
+
+void PngMonitor::decode(const QString& path)
+{
+    if (m_inFlight.contains(path)) {
+        return;
+    }
+    m_inFlight.insert(path);
+
+    QElapsedTimer detected;
+    detected.start();
+
+    m_decodePool.start([this, path, detected]() {
+        static LatencyHistogram& decodeLatency = MetricsRegistry::global().histogram(
+            "qhyni_png_decode_seconds", "Reading and decoding a screenshot from the watched folder");
+
+        // Taken before reading, so a rewrite during the read counts as one
+        const QFileInfo info(path);
+        const FileStamp stamp{info.size(), info.lastModified()};
+
+        QImageReader reader(path, "png");
+        QImage image = timed(decodeLatency, [&]() { return reader.read(); });
+        if (image.isNull()) {
+            qDebug() << "Failed to load PNG file:" << path << reader.errorString();
+        } else if (!QFile::remove(path)) {
+            qDebug() << "Failed to delete file:" << path;
+        }
+
+        QMetaObject::invokeMethod(this, [this, path, image = std::move(image), stamp, detected]() {
+            handleDecoded(path, image, stamp, detected);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PngMonitor::handleDecoded(const QString& path, const QImage& image, const FileStamp& stamp,
+                               const QElapsedTimer& detected)
+{
+    m_inFlight.remove(path);
+
+    if (image.isNull()) {
+        m_failed.insert(path, stamp);
+        return;
+    }
+
+    qDebug() << "Loaded PNG file:" << path << "in" << detected.elapsed() << "ms";
+    emit sendImage(image, detected);
+}
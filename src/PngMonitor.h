@@ -2,59 +2,71 @@
 #define PNG_MONITOR_H
 
 #include <QObject>
-#include <QDir>
-#include <QPixmap>
-#include <QDebug>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 
+class QSocketNotifier;
+
+// Watches a folder (typically synced from another machine) for screenshots
+// and hands each one over as a decoded QImage, deleting the file.
+//
+// On Linux files are picked up through inotify as soon as they are closed
+// after writing or renamed into the folder, so half-written files are never
+// read. Elsewhere, or when the folder cannot be watched, the folder is
+// polled and a file is only taken once its size stopped changing; a folder
+// that was missing is watched again once it is back. Decoding
+// always runs on a private thread pool, several files in parallel; the
+// owner's thread only sees finished images.
 class PngMonitor : public QObject
 {
     Q_OBJECT
 public:
-    PngMonitor(const QString &folderPath, QObject *parent = nullptr)
-        : QObject(parent), m_folderPath(folderPath)
-{
-    // Set up polling timer
-    connect(&m_pollTimer, &QTimer::timeout, this, &PngMonitor::checkForNewPngs);
-    m_pollTimer.setInterval(2500);
-    m_pollTimer.setSingleShot(false);
-    m_pollTimer.start();
-}
+    explicit PngMonitor(const QString &folderPath, QObject *parent = nullptr);
+    ~PngMonitor();
 
 signals:
-    void sendImage(const QPixmap& pixmap);
+    // detected was started when the file was found complete, so
+    // detected.elapsed() is the latency added since then.
+    void sendImage(const QImage& image, const QElapsedTimer& detected);
 
 private slots:
-    void checkForNewPngs()
-    {
-        QDir dir(m_folderPath);
-        QStringList pngFiles = dir.entryList(QStringList() << "*.png", QDir::Files);
-
-        foreach (const QString &file, pngFiles) {
-            QString fullPath = dir.filePath(file);
-
-            // Load as QPixmap
-            QPixmap pixmap;
-            if (pixmap.load(fullPath)) {
-                qDebug() << "Loaded PNG file:" << fullPath;
-
-                emit sendImage(pixmap);
-
-                // Delete the file
-                if (QFile::remove(fullPath)) {
-                    qDebug() << "Deleted file:" << fullPath;
-                } else {
-                    qDebug() << "Failed to delete file:" << fullPath;
-                }
-            } else {
-                qDebug() << "Failed to load PNG file:" << fullPath;
-            }
-        }
-    }
+    void readWatchEvents();
+    void checkForNewPngs();
 
 private:
-    QTimer m_pollTimer;
+    // Tells whether a file that failed to decode was written again since
+    struct FileStamp {
+        qint64 size{-1};
+        QDateTime modified;
+
+        bool operator==(const FileStamp& other) const {
+            return size == other.size && modified == other.modified;
+        }
+    };
+
+    bool startWatching();
+    void stopWatching();
+    void scanFolder(bool requireStableSize);
+    void decode(const QString& path);
+    void handleDecoded(const QString& path, const QImage& image, const FileStamp& stamp,
+                       const QElapsedTimer& detected);
+
     QString m_folderPath;
+    QTimer m_pollTimer;
+    QThreadPool m_decodePool;
+
+    int m_watchFd{-1};
+    QSocketNotifier* m_watchNotifier{nullptr};
+    bool m_retryWatch{false};           // polling only until the folder is back
+
+    QSet<QString> m_inFlight;           // being decoded
+    QHash<QString, FileStamp> m_failed; // not decodable, skipped until rewritten
+    QHash<QString, qint64> m_seenSizes; // polling: size at the previous check
 };
 
 #endif // PNG_MONITOR_H
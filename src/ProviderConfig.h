@@ -0,0 +1,40 @@
+#ifndef PROVIDER_CONFIG_H
+#define PROVIDER_CONFIG_H
+
+#include <QString>
+#include <QUrl>
+#include "chat_api.h"
+#include "config.h"
+
+// Chat-completions endpoint details used by the streaming path, which talks
+// to the providers directly instead of going through hyni::chat_api. hyni
+// does not expose its model choice, so the model here is the streaming
+// path's own and answers can differ from non-streamed ones.
+struct ProviderEndpoint {
+    QUrl url;
+    QString model;
+    const char* apiKeyEnv;
+    bool supportsImages;
+};
+
+// Set to send every provider's requests to another server, e.g. a local
+// qhyni_mock_llm. Only the streaming path honours it.
+constexpr const char* CHAT_API_URL_ENV = "QHYNI_CHAT_API_URL";
+
+inline ProviderEndpoint providerEndpoint(hyni::chat_api::API_PROVIDER provider) {
+    ProviderEndpoint endpoint;
+    if (provider == hyni::chat_api::API_PROVIDER::DeepSeek) {
+        endpoint = { QUrl("https://api.deepseek.com/chat/completions"),
+                     "deepseek-chat", "DS_API_KEY", false };
+    } else {
+        endpoint = { QUrl(QString::fromUtf8(hyni::GPT_API_URL)), "gpt-4o", "OA_API_KEY", true };
+    }
+
+    const QString overrideUrl = qEnvironmentVariable(CHAT_API_URL_ENV);
+    if (!overrideUrl.isEmpty()) {
+        endpoint.url = QUrl(overrideUrl);
+    }
+    return endpoint;
+}
+
+#endif // PROVIDER_CONFIG_H
@@ -0,0 +1,148 @@
+#include "ResponseCache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+// How many disk writes happen between two size checks of the cache folder
+constexpr int PRUNE_INTERVAL = 32;
+}
+
+ResponseCache::ResponseCache(const QString& directory,
+                             int memoryEntries,
+                             qint64 diskLimitBytes)
+    : m_memory(memoryEntries),
+    m_directory(directory),
+    m_diskLimitBytes(diskLimitBytes) {
+    if (!QDir().mkpath(m_directory)) {
+        qWarning() << "Failed to create response cache folder:" << m_directory;
+    }
+}
+
+QByteArray ResponseCache::makeKey(hyni::chat_api::API_PROVIDER provider,
+                                  hyni::chat_api::QUESTION_TYPE type,
+                                  const QString& language,
+                                  const QString& prompt,
+                                  const QByteArray& base64Image,
+                                  int maxTokens,
+                                  double temperature) {
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    // Every field is length-prefixed so that adjacent fields can't collide
+    const auto addField = [&hash](const QByteArray& field) {
+        const qint64 size = field.size();
+        hash.addData(QByteArrayView(reinterpret_cast<const char*>(&size), sizeof(size)));
+        hash.addData(field);
+    };
+
+    addField(QByteArray::number(static_cast<int>(provider)));
+    addField(QByteArray::number(static_cast<int>(type)));
+    addField(language.toUtf8());
+    addField(prompt.toUtf8());
+    addField(base64Image);
+    addField(QByteArray::number(maxTokens));
+    addField(QByteArray::number(temperature, 'g', 6));
+
+    return hash.result().toHex();
+}
+
+bool ResponseCache::lookup(const QByteArray& key, QString& response) {
+    if (!m_enabled.load()) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const QString* cached = m_memory.object(key)) {
+            response = *cached;
+            return true;
+        }
+    }
+
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+        return false;
+    }
+
+    uchar* data = file.map(0, file.size());
+    if (!data) {
+        return false;
+    }
+    response = QString::fromUtf8(reinterpret_cast<const char*>(data), file.size());
+    file.unmap(data);
+
+    QMutexLocker locker(&m_mutex);
+    m_memory.insert(key, new QString(response));
+    return true;
+}
+
+void ResponseCache::insert(const QByteArray& key, const QString& response) {
+    if (!m_enabled.load() || response.isEmpty()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_memory.insert(key, new QString(response));
+    }
+
+    // QSaveFile makes the write atomic, so a crash never leaves a
+    // truncated entry behind.
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write response cache entry:" << file.fileName();
+        return;
+    }
+    file.write(response.toUtf8());
+    if (!file.commit()) {
+        qWarning() << "Failed to commit response cache entry:" << file.fileName();
+        return;
+    }
+
+    bool prune = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (++m_writesSincePrune >= PRUNE_INTERVAL) {
+            m_writesSincePrune = 0;
+            prune = true;
+        }
+    }
+    if (prune) {
+        pruneDisk();
+    }
+}
+
+void ResponseCache::setEnabled(bool enabled) {
+    m_enabled.store(enabled);
+}
+
+bool ResponseCache::isEnabled() const {
+    return m_enabled.load();
+}
+
+QString ResponseCache::filePath(const QByteArray& key) const {
+    return m_directory + "/" + QString::fromLatin1(key) + ".md";
+}
+
+// Removes the least recently written entries once the folder grows past
+// the configured limit.
+void ResponseCache::pruneDisk() {
+    QDir dir(m_directory);
+    const QFileInfoList entries = dir.entryInfoList(QStringList() << "*.md",
+                                                    QDir::Files,
+                                                    QDir::Time);
+
+    qint64 total = 0;
+    for (const QFileInfo& entry : entries) {
+        total += entry.size();
+    }
+
+    // Newest first, so remove from the back
+    for (auto it = entries.crbegin(); it != entries.crend() && total > m_diskLimitBytes; ++it) {
+        total -= it->size();
+        QFile::remove(it->filePath());
+    }
+}
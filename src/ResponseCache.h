@@ -0,0 +1,51 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include "chat_api.h"
+
+// Content-addressed cache of assistant replies. Keys are a hash of
+// everything that influences the answer, so identical resends are served
+// locally instead of paying for another round trip.
+//
+// Two tiers: a small in-memory LRU and one file per entry on disk, which is
+// memory-mapped on lookup and survives restarts. Safe to share between the
+// API worker threads.
+class ResponseCache
+{
+public:
+    explicit ResponseCache(const QString& directory,
+                           int memoryEntries = 64,
+                           qint64 diskLimitBytes = 64 * 1024 * 1024);
+
+    static QByteArray makeKey(hyni::chat_api::API_PROVIDER provider,
+                              hyni::chat_api::QUESTION_TYPE type,
+                              const QString& language,
+                              const QString& prompt,
+                              const QByteArray& base64Image,
+                              int maxTokens,
+                              double temperature);
+
+    bool lookup(const QByteArray& key, QString& response);
+    void insert(const QByteArray& key, const QString& response);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+private:
+    QString filePath(const QByteArray& key) const;
+    void pruneDisk();
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray, QString> m_memory;
+    QString m_directory;
+    qint64 m_diskLimitBytes;
+    int m_writesSincePrune{0};
+    std::atomic<bool> m_enabled{true};
+};
+
+#endif // RESPONSE_CACHE_H
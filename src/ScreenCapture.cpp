@@ -0,0 +1,188 @@
+#include "ScreenCapture.h"
+#include <QDebug>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImageReader>
+#include <QPixmap>
+#include <QProcess>
+#include <QScreen>
+#include <QTemporaryDir>
+
+namespace {
+// The longest spectacle has ever needed for a single shot
+constexpr int SPECTACLE_TIMEOUT_MS = 5000;
+}
+
+ScreenCaptureBackend::ScreenCaptureBackend(QObject* parent)
+    : QObject(parent)
+{
+    m_delayTimer.setSingleShot(true);
+    connect(&m_delayTimer, &QTimer::timeout, this, [this]() {
+        m_timing.delayMs = m_elapsed.elapsed();
+        grab();
+    });
+}
+
+void ScreenCaptureBackend::capture(const CaptureOptions& options)
+{
+    m_options = options;
+    m_timing = CaptureTiming();
+    m_elapsed.start();
+    m_delayTimer.start(qMax(0, options.delayMs));
+}
+
+QString QScreenCapture::name() const
+{
+    return "screen";
+}
+
+void QScreenCapture::grab()
+{
+    QScreen* screen = QGuiApplication::primaryScreen();
+    if (!m_options.region.isEmpty()) {
+        if (QScreen* containing = QGuiApplication::screenAt(m_options.region.center())) {
+            screen = containing;
+        }
+    }
+    if (!screen) {
+        emit failed("No screen to capture");
+        return;
+    }
+
+    QElapsedTimer stage;
+    stage.start();
+
+    // grabWindow() takes coordinates relative to the screen
+    QPixmap pixmap;
+    if (m_options.region.isEmpty()) {
+        pixmap = screen->grabWindow(0);
+    } else {
+        const QRect region = m_options.region.translated(-screen->geometry().topLeft());
+        pixmap = screen->grabWindow(0, region.x(), region.y(), region.width(), region.height());
+    }
+    m_timing.grabMs = stage.restart();
+
+    if (pixmap.isNull()) {
+        emit failed("The platform does not allow grabbing the screen");
+        return;
+    }
+
+    const QImage image = pixmap.toImage();
+    m_timing.convertMs = stage.elapsed();
+    m_timing.totalMs = m_elapsed.elapsed();
+
+    emit captured(image, m_timing);
+}
+
+SpectacleCapture::SpectacleCapture(QObject* parent)
+    : ScreenCaptureBackend(parent)
+{
+    m_loadPool.setMaxThreadCount(1);
+}
+
+SpectacleCapture::~SpectacleCapture()
+{
+    if (m_process) {
+        m_process->kill();
+        m_process->waitForFinished(1000);
+    }
+    m_loadPool.waitForDone();
+    delete m_outputDir;
+}
+
+QString SpectacleCapture::name() const
+{
+    return "spectacle";
+}
+
+void SpectacleCapture::grab()
+{
+    if (!m_outputDir) {
+        m_outputDir = new QTemporaryDir();
+    }
+    if (!m_outputDir->isValid()) {
+        emit failed("Cannot create a temporary directory for spectacle");
+        return;
+    }
+
+    if (m_process) {
+        m_process->disconnect(this);
+        m_process->kill();
+        m_process->deleteLater();
+    }
+
+    const QString savePath = m_outputDir->filePath("capture.png");
+    QFile::remove(savePath);
+
+    m_process = new QProcess(this);
+    m_processTimer.start();
+
+    connect(m_process, &QProcess::finished, this, [this, savePath](int exitCode, QProcess::ExitStatus status) {
+        m_timing.grabMs = m_processTimer.elapsed();
+        m_process->deleteLater();
+        m_process = nullptr;
+
+        if (status != QProcess::NormalExit || exitCode != 0 || !QFile::exists(savePath)) {
+            emit failed("spectacle did not produce a screenshot");
+            return;
+        }
+        load(savePath);
+    });
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart) {
+            return; // finished() follows
+        }
+        m_process->deleteLater();
+        m_process = nullptr;
+        emit failed("Cannot start spectacle");
+    });
+
+    // A region is in screen coordinates, so it is cut from the full screen;
+    // otherwise the active window is taken
+    const QRect region = m_options.region;
+    m_crop = QRect();
+    if (!region.isEmpty()) {
+        // The full-screen shot starts at the top left of the virtual desktop
+        // and is in device pixels
+        QScreen* screen = QGuiApplication::primaryScreen();
+        const QPoint origin = screen ? screen->virtualGeometry().topLeft() : QPoint();
+        const qreal ratio = screen ? screen->devicePixelRatio() : 1.0;
+        const QRect local = region.translated(-origin);
+        m_crop = QRect(qRound(local.x() * ratio), qRound(local.y() * ratio),
+                       qRound(local.width() * ratio), qRound(local.height() * ratio));
+    }
+    const QString mode = region.isEmpty() ? "-a" : "-f";
+    m_process->start("spectacle", {mode, "-b", "--nonotify", "-o", savePath});
+
+    // A hung spectacle must not leave the capture pending forever
+    QTimer::singleShot(SPECTACLE_TIMEOUT_MS, m_process, [process = m_process]() {
+        process->kill();
+    });
+}
+
+void SpectacleCapture::load(const QString& path)
+{
+    const QRect region = m_crop;
+
+    m_loadPool.start([this, path, region]() {
+        QElapsedTimer stage;
+        stage.start();
+
+        QImage image = QImageReader(path, "png").read();
+        QFile::remove(path);
+        if (!image.isNull() && !region.isEmpty()) {
+            image = image.copy(region);
+        }
+        const qint64 convertMs = stage.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, image = std::move(image), convertMs]() {
+            if (image.isNull()) {
+                emit failed("Cannot read the spectacle screenshot");
+                return;
+            }
+            m_timing.convertMs = convertMs;
+            m_timing.totalMs = m_elapsed.elapsed();
+            emit captured(image, m_timing);
+        }, Qt::QueuedConnection);
+    });
+}
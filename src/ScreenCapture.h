@@ -0,0 +1,100 @@
+#ifndef SCREEN_CAPTURE_H
+#define SCREEN_CAPTURE_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QThreadPool>
+#include <QTimer>
+
+class QProcess;
+class QTemporaryDir;
+
+struct CaptureOptions {
+    int delayMs{3000};  // time to switch to the window being captured
+    QRect region;       // in screen coordinates, empty for the whole screen
+};
+
+// Milliseconds spent in each stage of one capture
+struct CaptureTiming {
+    qint64 delayMs{0};
+    qint64 grabMs{0};     // taking the screenshot
+    qint64 convertMs{0};  // turning it into a QImage and cropping
+    qint64 totalMs{0};
+};
+
+// Takes a screenshot after the configured delay and delivers it as a
+// QImage. capture() returns immediately; a new capture replaces one that
+// is still waiting for its delay.
+class ScreenCaptureBackend : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScreenCaptureBackend(QObject* parent = nullptr);
+
+    virtual QString name() const = 0;
+    void capture(const CaptureOptions& options);
+
+signals:
+    void captured(const QImage& image, const CaptureTiming& timing);
+    void failed(const QString& error);
+
+protected:
+    // Called once the delay has passed; must end in captured() or failed().
+    virtual void grab() = 0;
+
+    CaptureOptions m_options;
+    CaptureTiming m_timing;
+    QElapsedTimer m_elapsed;
+
+private:
+    QTimer m_delayTimer;
+};
+
+// Grabs the screen in-process. Qt only allows QScreen::grabWindow() on the
+// GUI thread, so the grab itself happens there, but nothing waits, spawns
+// a process or touches the disk; encoding happens later on the API worker.
+// Fails on platforms that do not allow grabbing, such as most Wayland
+// compositors. Qt can't tell which window of another application is
+// active, so without a region this takes the whole primary screen rather
+// than the active window spectacle takes.
+class QScreenCapture : public ScreenCaptureBackend
+{
+    Q_OBJECT
+public:
+    using ScreenCaptureBackend::ScreenCaptureBackend;
+
+    QString name() const override;
+
+protected:
+    void grab() override;
+};
+
+// Runs KDE's spectacle and reads its output back from a temporary
+// directory on a worker thread. Takes the active window, or the full
+// screen cropped to the region when one is set. Neither the process nor
+// the file are waited for on the calling thread.
+class SpectacleCapture : public ScreenCaptureBackend
+{
+    Q_OBJECT
+public:
+    explicit SpectacleCapture(QObject* parent = nullptr);
+    ~SpectacleCapture();
+
+    QString name() const override;
+
+protected:
+    void grab() override;
+
+private:
+    void load(const QString& path);
+
+    QProcess* m_process{nullptr};
+    QElapsedTimer m_processTimer;
+    QTemporaryDir* m_outputDir{nullptr};
+    QRect m_crop;  // the region in the screenshot's pixels
+    QThreadPool m_loadPool;
+};
+
+#endif // SCREEN_CAPTURE_H
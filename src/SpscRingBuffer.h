@@ -0,0 +1,101 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Fixed-capacity, lock-free single-producer/single-consumer queue. All
+// storage is allocated up front, so neither side ever touches the heap.
+//
+// Besides push()/pop(), slots can be filled and read in place:
+//   producer: T* slot = acquire(); ...fill *slot...; publish();
+//   consumer: T* slot = front();   ...read *slot...; release();
+template <typename T, std::size_t Capacity>
+class SpscRingBuffer
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    // Producer side
+    T* acquire() {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) {
+                return nullptr;
+            }
+        }
+        return &m_slots[head & MASK];
+    }
+
+    void publish() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool push(T value) {
+        T* slot = acquire();
+        if (!slot) {
+            return false;
+        }
+        *slot = std::move(value);
+        publish();
+        return true;
+    }
+
+    // Consumer side
+    T* front() {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) {
+                return nullptr;
+            }
+        }
+        return &m_slots[tail & MASK];
+    }
+
+    void release() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool pop(T& value) {
+        T* slot = front();
+        if (!slot) {
+            return false;
+        }
+        value = std::move(*slot);
+        release();
+        return true;
+    }
+
+    // Approximate when called concurrently with the other side
+    std::size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    static constexpr std::size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Head and tail on separate cache lines, each next to the copy of the
+    // other index that its owner caches to avoid cross-core traffic.
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail{0};
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_cachedHead{0};
+    alignas(CACHE_LINE) std::array<T, Capacity> m_slots{};
+};
+
+#endif // SPSC_RING_BUFFER_H
@@ -0,0 +1,69 @@
+#ifndef SSE_PARSER_H
+#define SSE_PARSER_H
+
+#include <QByteArray>
+#include <functional>
+
+// Incremental parser for text/event-stream bodies. Network chunks can split
+// lines anywhere, so bytes are buffered until a full line is available and
+// the "data:" payload of each event is handed to the callback once the
+// blank line terminating the event is seen.
+class SseParser
+{
+public:
+    using EventHandler = std::function<void(const QByteArray& data)>;
+
+    void feed(const QByteArray& chunk, const EventHandler& onEvent)
+    {
+        m_pending.append(chunk);
+
+        qsizetype start = 0;
+        qsizetype newline;
+        while ((newline = m_pending.indexOf('\n', start)) >= 0) {
+            QByteArray line = m_pending.mid(start, newline - start);
+            start = newline + 1;
+
+            if (line.endsWith('\r')) {
+                line.chop(1);
+            }
+
+            if (line.isEmpty()) {
+                // End of event
+                if (!m_data.isEmpty()) {
+                    onEvent(m_data);
+                    m_data.clear();
+                }
+            } else if (line.startsWith("data:")) {
+                QByteArray payload = line.mid(5);
+                if (payload.startsWith(' ')) {
+                    payload.remove(0, 1);
+                }
+                if (!m_data.isEmpty()) {
+                    m_data.append('\n');
+                }
+                m_data.append(payload);
+            }
+            // Comments (":") and other fields (event, id, retry) are ignored
+        }
+
+        m_pending.remove(0, start);
+    }
+
+    // Flush a trailing event that was not terminated by a blank line.
+    void finish(const EventHandler& onEvent)
+    {
+        if (!m_pending.isEmpty()) {
+            feed("\n", onEvent);
+        }
+        if (!m_data.isEmpty()) {
+            onEvent(m_data);
+            m_data.clear();
+        }
+    }
+
+private:
+    QByteArray m_pending;
+    QByteArray m_data;
+};
+
+#endif // SSE_PARSER_H
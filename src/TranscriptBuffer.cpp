@@ -0,0 +1,137 @@
+#include "TranscriptBuffer.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSCRIPT_BUFFER_SSE
+#endif
+
+namespace {
+// Shorter overlaps are too likely to be coincidence ("a", "is", "the")
+constexpr qsizetype MIN_OVERLAP = 4;
+
+bool isWordCharacter(QChar c) {
+    return c.isLetterOrNumber() || c == u'\'';
+}
+}
+
+TranscriptBuffer::TranscriptBuffer(qsizetype window)
+    : m_window(std::max(window, MIN_OVERLAP)), m_useSimd(simdAvailable())
+{
+}
+
+const QString& TranscriptBuffer::text() const
+{
+    return m_text;
+}
+
+bool TranscriptBuffer::isEmpty() const
+{
+    return m_text.isEmpty();
+}
+
+void TranscriptBuffer::setText(const QString& text)
+{
+    m_text = text.trimmed();
+}
+
+void TranscriptBuffer::clear()
+{
+    m_text.clear();
+}
+
+qsizetype TranscriptBuffer::append(QStringView fragment)
+{
+    fragment = fragment.trimmed();
+    if (fragment.isEmpty()) {
+        return 0;
+    }
+
+    const qsizetype overlap = findOverlap(fragment);
+    const QStringView rest = fragment.mid(overlap);
+    if (rest.isEmpty()) {
+        return overlap;
+    }
+
+    if (overlap == 0 && !m_text.isEmpty()) {
+        m_text.append(u' ');
+    }
+    m_text.append(rest);
+    return overlap;
+}
+
+bool TranscriptBuffer::isOverlapStart(qsizetype position) const
+{
+    // The overlap has to begin a word of the transcript
+    return position == 0 || !isWordCharacter(m_text.at(position - 1)) ||
+           !isWordCharacter(m_text.at(position));
+}
+
+qsizetype TranscriptBuffer::findOverlap(QStringView fragment) const
+{
+    const qsizetype maxOverlap = std::min({m_window, fragment.size(), m_text.size()});
+    if (maxOverlap < MIN_OVERLAP) {
+        return 0;
+    }
+
+    // Candidate p means the fragment starts at tail[p]; the earliest
+    // candidate that matches is the longest overlap.
+    const qsizetype tailStart = m_text.size() - maxOverlap;
+    const char16_t* tail = reinterpret_cast<const char16_t*>(m_text.utf16()) + tailStart;
+    const char16_t* head = reinterpret_cast<const char16_t*>(fragment.utf16());
+    const qsizetype lastCandidate = maxOverlap - MIN_OVERLAP;
+
+    auto matches = [&](qsizetype p) {
+        return isOverlapStart(tailStart + p) &&
+               std::memcmp(tail + p, head, std::size_t(maxOverlap - p) * sizeof(char16_t)) == 0;
+    };
+
+    qsizetype p = 0;
+
+#ifdef TRANSCRIPT_BUFFER_SSE
+    // Eight candidates per step: positions where both of the fragment's
+    // first two characters line up. Only those get the full comparison.
+    if (m_useSimd) {
+        const __m128i first = _mm_set1_epi16(static_cast<short>(head[0]));
+        const __m128i second = _mm_set1_epi16(static_cast<short>(head[1]));
+
+        for (; p + 8 <= lastCandidate + 1; p += 8) {
+            const __m128i at = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail + p));
+            const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail + p + 1));
+            unsigned mask = unsigned(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi16(at, first), _mm_cmpeq_epi16(next, second))));
+
+            while (mask != 0) {
+                const int bit = std::countr_zero(mask);
+                if (matches(p + bit / 2)) {
+                    return maxOverlap - (p + bit / 2);
+                }
+                mask &= ~(3u << bit);
+            }
+        }
+    }
+#endif
+
+    for (; p <= lastCandidate; ++p) {
+        if (tail[p] == head[0] && tail[p + 1] == head[1] && matches(p)) {
+            return maxOverlap - p;
+        }
+    }
+    return 0;
+}
+
+bool TranscriptBuffer::simdAvailable()
+{
+#ifdef TRANSCRIPT_BUFFER_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TranscriptBuffer::setSimdEnabled(bool enabled)
+{
+    m_useSimd = enabled && simdAvailable();
+}
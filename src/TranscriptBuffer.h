@@ -0,0 +1,47 @@
+#ifndef TRANSCRIPT_BUFFER_H
+#define TRANSCRIPT_BUFFER_H
+
+#include <QString>
+#include <QStringView>
+
+// Accumulates the transcript of one question from the overlapping
+// fragments the transcription server sends.
+//
+// Each fragment usually repeats the end of the previous one. append() looks
+// for the longest suffix of the transcript that is a prefix of the fragment
+// and appends only the rest, so a fragment costs time proportional to its
+// own length: the search never looks further back than the window, and the
+// text is kept as UTF-16 and only ever appended to. An overlap has to start
+// at a word boundary and be at least a few characters long, so a fragment
+// starting with "a" is not glued onto a transcript ending in "a".
+class TranscriptBuffer
+{
+public:
+    static constexpr qsizetype DEFAULT_WINDOW = 512;
+
+    explicit TranscriptBuffer(qsizetype window = DEFAULT_WINDOW);
+
+    const QString& text() const;
+    bool isEmpty() const;
+    void setText(const QString& text);
+    void clear();
+
+    // Returns how many characters of the fragment were already present.
+    qsizetype append(QStringView fragment);
+
+    // Length of the longest overlap between the end of the transcript and
+    // the start of fragment, 0 when there is none.
+    qsizetype findOverlap(QStringView fragment) const;
+
+    static bool simdAvailable();
+    void setSimdEnabled(bool enabled);
+
+private:
+    bool isOverlapStart(qsizetype position) const;
+
+    QString m_text;
+    qsizetype m_window;
+    bool m_useSimd;
+};
+
+#endif // TRANSCRIPT_BUFFER_H
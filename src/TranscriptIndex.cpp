@@ -0,0 +1,179 @@
+#include "TranscriptIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+constexpr qsizetype GRAM_LENGTH = 3;
+}
+
+void TranscriptIndex::clear()
+{
+    m_rows.clear();
+    m_postings.clear();
+}
+
+int TranscriptIndex::rowCount() const
+{
+    return int(m_rows.size());
+}
+
+std::vector<TranscriptIndex::Gram> TranscriptIndex::gramsOf(QStringView folded)
+{
+    std::vector<Gram> grams;
+    if (folded.size() < GRAM_LENGTH) {
+        return grams;
+    }
+
+    grams.reserve(std::size_t(folded.size() - GRAM_LENGTH + 1));
+    for (qsizetype i = 0; i + GRAM_LENGTH <= folded.size(); ++i) {
+        grams.push_back(Gram(folded[i].unicode()) << 32 |
+                        Gram(folded[i + 1].unicode()) << 16 |
+                        Gram(folded[i + 2].unicode()));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void TranscriptIndex::addGrams(int row, QStringView folded)
+{
+    for (Gram gram : gramsOf(folded)) {
+        std::vector<int>& rows = m_postings[gram];
+        // Rows are almost always added at the end
+        if (rows.empty() || rows.back() < row) {
+            rows.push_back(row);
+        } else {
+            auto it = std::lower_bound(rows.begin(), rows.end(), row);
+            if (it == rows.end() || *it != row) {
+                rows.insert(it, row);
+            }
+        }
+    }
+}
+
+void TranscriptIndex::removeGrams(int row, QStringView folded)
+{
+    for (Gram gram : gramsOf(folded)) {
+        auto posting = m_postings.find(gram);
+        if (posting == m_postings.end()) {
+            continue;
+        }
+        std::vector<int>& rows = posting.value();
+        auto it = std::lower_bound(rows.begin(), rows.end(), row);
+        if (it != rows.end() && *it == row) {
+            rows.erase(it);
+        }
+        if (rows.empty()) {
+            m_postings.erase(posting);
+        }
+    }
+}
+
+void TranscriptIndex::setRow(int row, const QString& text)
+{
+    if (row < 0 || row > rowCount()) {
+        return;
+    }
+    if (row == rowCount()) {
+        m_rows.emplace_back();
+    } else {
+        removeGrams(row, m_rows[std::size_t(row)]);
+    }
+
+    m_rows[std::size_t(row)] = text.toCaseFolded();
+    addGrams(row, m_rows[std::size_t(row)]);
+}
+
+void TranscriptIndex::appendToRow(int row, QStringView added)
+{
+    if (row < 0 || row >= rowCount() || added.isEmpty()) {
+        return;
+    }
+
+    QString& folded = m_rows[std::size_t(row)];
+    // The grams spanning the old end of the row are new as well
+    const qsizetype from = std::max<qsizetype>(0, folded.size() - (GRAM_LENGTH - 1));
+    folded.append(added.toString().toCaseFolded());
+    addGrams(row, QStringView(folded).mid(from));
+}
+
+QList<int> TranscriptIndex::find(const QString& text) const
+{
+    const QString query = text.toCaseFolded();
+    QList<int> result;
+    if (query.isEmpty()) {
+        return result;
+    }
+
+    // Too short for a gram, look at every row
+    if (query.size() < GRAM_LENGTH) {
+        for (int row = 0; row < rowCount(); ++row) {
+            if (m_rows[std::size_t(row)].contains(query)) {
+                result.append(row);
+            }
+        }
+        return result;
+    }
+
+    std::vector<const std::vector<int>*> lists;
+    for (Gram gram : gramsOf(query)) {
+        auto posting = m_postings.constFind(gram);
+        if (posting == m_postings.constEnd()) {
+            return result;
+        }
+        lists.push_back(&posting.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) {
+        return a->size() < b->size();
+    });
+
+    std::vector<int> candidates = *lists.front();
+    std::vector<int> narrowed;
+    for (std::size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        narrowed.clear();
+        std::set_intersection(candidates.begin(), candidates.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(narrowed));
+        candidates.swap(narrowed);
+    }
+
+    // Sharing every gram does not yet mean they are adjacent
+    for (int row : candidates) {
+        if (m_rows[std::size_t(row)].contains(query)) {
+            result.append(row);
+        }
+    }
+    return result;
+}
+
+QList<int> TranscriptIndex::findFuzzy(const QString& text, double minSimilarity) const
+{
+    const QString query = text.toCaseFolded();
+    const std::vector<Gram> grams = gramsOf(query);
+    if (grams.empty()) {
+        return find(text);
+    }
+
+    std::vector<int> shared(m_rows.size(), 0);
+    for (Gram gram : grams) {
+        auto posting = m_postings.constFind(gram);
+        if (posting != m_postings.constEnd()) {
+            for (int row : posting.value()) {
+                ++shared[std::size_t(row)];
+            }
+        }
+    }
+
+    const int required = std::max(1, int(std::ceil(minSimilarity * double(grams.size()))));
+    QList<int> result;
+    for (int row = 0; row < rowCount(); ++row) {
+        if (shared[std::size_t(row)] >= required) {
+            result.append(row);
+        }
+    }
+    std::stable_sort(result.begin(), result.end(), [&shared](int a, int b) {
+        return shared[std::size_t(a)] > shared[std::size_t(b)];
+    });
+    return result;
+}
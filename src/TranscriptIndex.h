@@ -0,0 +1,47 @@
+#ifndef TRANSCRIPT_INDEX_H
+#define TRANSCRIPT_INDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <vector>
+
+// Case-insensitive trigram index over the rows of the transcript table.
+//
+// Every row's case-folded text is split into overlapping three-character
+// grams, and each gram maps to the sorted list of rows containing it. A
+// substring search intersects the lists of the query's grams, starting with
+// the rarest, and only verifies the rows left over. A fuzzy search ranks
+// rows by how many of the query's grams they share, which tolerates the
+// odd misheard word. Rows that grow at the end, as transcript rows do, are
+// updated in time proportional to the added text.
+class TranscriptIndex
+{
+public:
+    void clear();
+
+    // Replaces the text of row, which may be one past the last row.
+    void setRow(int row, const QString& text);
+    // Extends the text of an existing row.
+    void appendToRow(int row, QStringView added);
+
+    int rowCount() const;
+
+    // Rows containing text, in ascending order.
+    QList<int> find(const QString& text) const;
+    // Rows sharing at least minSimilarity of text's grams, best first.
+    QList<int> findFuzzy(const QString& text, double minSimilarity = 0.6) const;
+
+private:
+    using Gram = quint64;
+
+    static std::vector<Gram> gramsOf(QStringView folded);
+    void addGrams(int row, QStringView folded);
+    void removeGrams(int row, QStringView folded);
+
+    std::vector<QString> m_rows;  // case-folded
+    QHash<Gram, std::vector<int>> m_postings;
+};
+
+#endif // TRANSCRIPT_INDEX_H
@@ -0,0 +1,773 @@
+#include "TranscriptionClient.h"
+#include "Metrics.h"
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace beast = boost::beast;
+namespace websocket = boost::beast::websocket;
+
+namespace {
+
+constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(5);
+
+// Recycled message buffers kept for the next audio frames
+constexpr std::size_t MAX_SPARE_BUFFERS = 8;
+
+// How long audio waits for the server's hello before going out as PCM
+constexpr auto HELLO_TIMEOUT = std::chrono::seconds(1);
+
+struct ClientMetrics {
+    LatencyHistogram& write = MetricsRegistry::global().histogram(
+        "qhyni_ws_write_seconds", "Writing one message to the transcription server");
+    MetricGauge& audioQueueDepth = MetricsRegistry::global().gauge(
+        "qhyni_ws_audio_queue_depth", "Audio messages waiting to be sent");
+    MetricCounter& audioBytes = MetricsRegistry::global().counter(
+        "qhyni_ws_audio_bytes_total", "Encoded audio bytes sent");
+    MetricCounter& transcripts = MetricsRegistry::global().counter(
+        "qhyni_ws_transcripts_total", "Transcripts received from the server");
+};
+
+ClientMetrics& metrics() {
+    static ClientMetrics metrics;
+    return metrics;
+}
+
+std::string makeStreamId(std::minstd_rand::result_type a, std::minstd_rand::result_type b) {
+    char id[17];
+    std::snprintf(id, sizeof(id), "%08x%08x", unsigned(a), unsigned(b));
+    return id;
+}
+
+std::vector<std::uint8_t> toBytes(const QByteArray& text) {
+    return std::vector<std::uint8_t>(text.begin(), text.end());
+}
+
+} // namespace
+
+TranscriptionClient::TranscriptionClient(boost::asio::io_context& ioContext,
+                                         const std::string& host,
+                                         const std::string& port,
+                                         int sampleRate)
+    : m_ioContext(ioContext),
+      m_resolver(ioContext),
+      m_host(host),
+      m_port(port),
+      m_sampleRate(sampleRate),
+      m_reconnectTimer(ioContext),
+      m_random(std::random_device{}()),
+      m_helloTimer(ioContext),
+      m_replayCapacity(std::size_t(sampleRate * DEFAULT_REPLAY_DURATION.count() / 1000))
+{
+    m_streamId = makeStreamId(m_random(), m_random());
+}
+
+void TranscriptionClient::setMessagesReadyHandler(MessagesReadyHandler handler)
+{
+    m_messagesReady = std::move(handler);
+}
+
+void TranscriptionClient::setConnectionHandler(ConnectionHandler handler)
+{
+    m_connectionHandler = std::move(handler);
+}
+
+void TranscriptionClient::setErrorHandler(ErrorHandler handler)
+{
+    m_errorHandler = std::move(handler);
+}
+
+void TranscriptionClient::setAudioSpaceHandler(std::function<void()> handler)
+{
+    m_audioSpace = std::move(handler);
+}
+
+void TranscriptionClient::connect()
+{
+    boost::asio::post(m_ioContext, [self = shared_from_this()]() {
+        self->startConnect();
+    });
+}
+
+void TranscriptionClient::startConnect()
+{
+    if (m_shutdown || m_connecting || m_connected) {
+        return;
+    }
+
+    // Also turns a pending reconnect into a no-op
+    m_connecting = true;
+    const unsigned generation = ++m_generation;
+    m_ws = std::make_shared<WebSocket>(m_ioContext);
+    m_readBuffer.clear();
+    m_resolver.async_resolve(
+        m_host, m_port,
+        [self = shared_from_this(), generation](beast::error_code ec,
+                                                boost::asio::ip::tcp::resolver::results_type results) {
+            self->onResolve(generation, ec, results);
+        });
+}
+
+void TranscriptionClient::scheduleReconnect()
+{
+    const std::chrono::milliseconds delay = nextReconnectDelay();
+    ++m_reconnectAttempts;
+    m_reconnects.fetch_add(1, std::memory_order_relaxed);
+
+    m_reconnectTimer.expires_after(delay);
+    m_reconnectTimer.async_wait([self = shared_from_this(), generation = m_generation](beast::error_code ec) {
+        if (ec || generation != self->m_generation) {
+            return;
+        }
+        self->startConnect();
+    });
+}
+
+std::chrono::milliseconds TranscriptionClient::nextReconnectDelay()
+{
+    // A restarted server is usually back right away
+    if (m_reconnectAttempts == 0) {
+        return std::chrono::milliseconds(0);
+    }
+
+    const double base = std::min(double(m_reconnectPolicy.maxDelay.count()),
+                                 double(m_reconnectPolicy.initialDelay.count()) *
+                                     std::pow(m_reconnectPolicy.multiplier, double(m_reconnectAttempts - 1)));
+    const double jitter = std::clamp(m_reconnectPolicy.jitter, 0.0, 1.0);
+    std::uniform_real_distribution<double> random(0.0, base * jitter);
+    return std::chrono::milliseconds(std::llround(base * (1.0 - jitter) + random(m_random)));
+}
+
+void TranscriptionClient::shutdown()
+{
+    // Handlers usually point into objects that are about to go away, so
+    // none are called from here on even if the post below never runs.
+    m_shutdown = true;
+
+    boost::asio::post(m_ioContext, [self = shared_from_this()]() {
+        ++self->m_generation;
+        self->m_resolver.cancel();
+        self->m_reconnectTimer.cancel();
+        self->m_helloTimer.cancel();
+        if (self->m_ws) {
+            beast::error_code ignored;
+            beast::get_lowest_layer(*self->m_ws).socket().close(ignored);
+        }
+        self->m_connecting = false;
+        self->m_connected = false;
+        self->m_streaming = false;
+        self->m_writing = false;
+        self->clearQueues();
+    });
+}
+
+bool TranscriptionClient::isConnected() const
+{
+    return m_connected;
+}
+
+void TranscriptionClient::setReconnectPolicy(const ReconnectPolicy& policy)
+{
+    boost::asio::post(m_ioContext, [self = shared_from_this(), policy]() {
+        self->m_reconnectPolicy = policy;
+    });
+}
+
+void TranscriptionClient::setReplayDuration(std::chrono::milliseconds duration)
+{
+    boost::asio::post(m_ioContext, [self = shared_from_this(), duration]() {
+        self->m_replayCapacity = std::size_t(std::max<long long>(0, self->m_sampleRate * duration.count() / 1000));
+    });
+}
+
+void TranscriptionClient::setAudioQueue(std::size_t capacity, OverflowPolicy policy)
+{
+    boost::asio::post(m_ioContext, [self = shared_from_this(), capacity, policy]() {
+        self->m_audioCapacity = std::max<std::size_t>(1, capacity);
+        self->m_overflowPolicy = policy;
+        // Drop what no longer fits rather than leave the queue over its bound
+        if (policy == OverflowPolicy::DropOldest) {
+            while (self->m_audioLane.size() > self->m_audioCapacity) {
+                self->popAudio();
+                self->m_audioDroppedOldest.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (policy != OverflowPolicy::BlockCapture ||
+            self->m_audioLane.size() < self->m_audioCapacity) {
+            self->notifyAudioSpace();
+        }
+    });
+}
+
+void TranscriptionClient::setResumeEnabled(bool enabled)
+{
+    boost::asio::post(m_ioContext, [self = shared_from_this(), enabled]() {
+        if (self->m_resumeEnabled == enabled) {
+            return;
+        }
+        self->m_resumeEnabled = enabled;
+        if (!enabled) {
+            self->m_serverResumes = false;
+        } else if (self->m_connected) {
+            self->sendHello();
+        }
+    });
+}
+
+void TranscriptionClient::setCompressionEnabled(bool enabled)
+{
+    boost::asio::post(m_ioContext, [self = shared_from_this(), enabled]() {
+        if (self->m_compressionEnabled == enabled) {
+            return;
+        }
+        self->m_compressionEnabled = enabled;
+        if (self->m_connected) {
+            self->sendHello();
+        }
+    });
+}
+
+AudioCodec TranscriptionClient::audioCodec() const
+{
+    return m_codec;
+}
+
+TranscriptionClient::Stats TranscriptionClient::stats() const
+{
+    Stats stats;
+    stats.audioMessages = m_audioMessages.load(std::memory_order_relaxed);
+    stats.audioBytes = m_audioBytes.load(std::memory_order_relaxed);
+    stats.pcmBytes = m_pcmBytes.load(std::memory_order_relaxed);
+    stats.messagesReceived = m_messagesReceived.load(std::memory_order_relaxed);
+    stats.messagesUnknown = m_messagesUnknown.load(std::memory_order_relaxed);
+    stats.messagesMalformed = m_messagesMalformed.load(std::memory_order_relaxed);
+    stats.messagesDropped = m_messagesDropped.load(std::memory_order_relaxed);
+    stats.reconnects = m_reconnects.load(std::memory_order_relaxed);
+    stats.audioReplayed = m_audioReplayed.load(std::memory_order_relaxed);
+    stats.audioLost = m_audioLost.load(std::memory_order_relaxed);
+    stats.audioQueueDepth = m_audioQueueDepth.load(std::memory_order_relaxed);
+    stats.audioQueueHighWater = m_audioQueueHighWater.load(std::memory_order_relaxed);
+    stats.audioDroppedOldest = m_audioDroppedOldest.load(std::memory_order_relaxed);
+    stats.audioDroppedNewest = m_audioDroppedNewest.load(std::memory_order_relaxed);
+    stats.captureBlocks = m_captureBlocks.load(std::memory_order_relaxed);
+    stats.controlQueueDepth = m_controlQueueDepth.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool TranscriptionClient::sendAudio(const std::int16_t* samples, std::size_t count)
+{
+    if (count == 0) {
+        return false;
+    }
+
+    const std::uint64_t seq = m_nextSeq++;
+    remember(seq, samples, count);
+    if (!m_streaming) {
+        return false;
+    }
+
+    return queueAudio(seq, samples, count);
+}
+
+bool TranscriptionClient::audioQueueFull()
+{
+    if (m_overflowPolicy != OverflowPolicy::BlockCapture || !m_streaming ||
+        m_audioLane.size() < m_audioCapacity) {
+        return false;
+    }
+    if (!m_audioBlocked) {
+        m_audioBlocked = true;
+        m_captureBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void TranscriptionClient::remember(std::uint64_t seq, const std::int16_t* samples, std::size_t count)
+{
+    if (m_replayCapacity == 0) {
+        return;
+    }
+
+    std::vector<std::int16_t> frame = takeFrame();
+    frame.assign(samples, samples + count);
+    m_replay.push_back(ReplayFrame{seq, std::move(frame)});
+    m_replaySamples += count;
+
+    while (m_replaySamples > m_replayCapacity && m_replay.size() > 1) {
+        ReplayFrame& oldest = m_replay.front();
+        if (oldest.seq > m_lastWrittenSeq && !m_streaming) {
+            m_audioLost.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_replaySamples -= oldest.samples.size();
+        m_spareFrames.push_back(std::move(oldest.samples));
+        m_replay.pop_front();
+    }
+}
+
+bool TranscriptionClient::queueAudio(std::uint64_t seq, const std::int16_t* samples, std::size_t count)
+{
+    if (m_audioLane.size() >= m_audioCapacity) {
+        switch (m_overflowPolicy) {
+        case OverflowPolicy::DropNewest:
+            m_audioDroppedNewest.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        case OverflowPolicy::DropOldest:
+            popAudio();
+            m_audioDroppedOldest.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case OverflowPolicy::BlockCapture:
+            // Capture checks audioQueueFull() per frame; what one frame
+            // turns into may still overshoot a little.
+            break;
+        }
+    }
+
+    pushAudio(seq, samples, count);
+    if (!m_writing) {
+        doWrite();
+    }
+    return true;
+}
+
+void TranscriptionClient::pushAudio(std::uint64_t seq, const std::int16_t* samples, std::size_t count)
+{
+    std::vector<std::int16_t> frame = takeFrame();
+    frame.assign(samples, samples + count);
+    m_audioLane.push_back(ReplayFrame{seq, std::move(frame)});
+
+    const std::uint64_t depth = m_audioLane.size();
+    m_audioQueueDepth.store(depth, std::memory_order_relaxed);
+    metrics().audioQueueDepth.set(std::int64_t(depth));
+    if (depth > m_audioQueueHighWater.load(std::memory_order_relaxed)) {
+        m_audioQueueHighWater.store(depth, std::memory_order_relaxed);
+    }
+}
+
+void TranscriptionClient::popAudio()
+{
+    m_spareFrames.push_back(std::move(m_audioLane.front().samples));
+    m_audioLane.pop_front();
+    m_audioQueueDepth.store(m_audioLane.size(), std::memory_order_relaxed);
+    metrics().audioQueueDepth.set(std::int64_t(m_audioLane.size()));
+}
+
+void TranscriptionClient::clearQueues()
+{
+    // Whatever was queued is still in the replay buffer
+    while (!m_audioLane.empty()) {
+        popAudio();
+    }
+    m_controlLane.clear();
+    m_controlQueueDepth.store(0, std::memory_order_relaxed);
+    notifyAudioSpace();
+}
+
+void TranscriptionClient::notifyAudioSpace()
+{
+    if (!m_audioBlocked) {
+        return;
+    }
+    m_audioBlocked = false;
+    if (m_audioSpace && !m_shutdown) {
+        boost::asio::post(m_ioContext, [self = shared_from_this()]() {
+            if (self->m_audioSpace && !self->m_shutdown) {
+                self->m_audioSpace();
+            }
+        });
+    }
+}
+
+void TranscriptionClient::startStreaming()
+{
+    m_awaitingHello = false;
+    m_helloTimer.cancel();
+    m_streaming = true;
+    m_wireSeq = 0;  // a resuming server gets an audio_resume first
+
+    // A server that resumes streams gets the whole buffer and drops what it
+    // already has; it may also have restarted and lost audio it had received
+    // but not transcribed. Anything else only gets what never went out.
+    // Replayed audio is bounded by the replay duration, not the queue.
+    auto first = m_replay.begin();
+    if (!m_serverResumes) {
+        first = std::find_if(m_replay.begin(), m_replay.end(), [this](const ReplayFrame& frame) {
+            return frame.seq > m_lastWrittenSeq;
+        });
+    }
+
+    for (auto it = first; it != m_replay.end(); ++it) {
+        pushAudio(it->seq, it->samples.data(), it->samples.size());
+        m_audioReplayed.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!m_writing && !m_audioLane.empty()) {
+        doWrite();
+    }
+}
+
+bool TranscriptionClient::sendText(const std::string& message)
+{
+    if (!m_connected) {
+        return false;
+    }
+    queueControl(Outgoing{std::vector<std::uint8_t>(message.begin(), message.end()), false});
+    return true;
+}
+
+void TranscriptionClient::onResolve(unsigned generation, beast::error_code ec,
+                                    boost::asio::ip::tcp::resolver::results_type results)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    if (ec) {
+        return fail("resolve", ec);
+    }
+
+    beast::get_lowest_layer(*m_ws).expires_after(CONNECT_TIMEOUT);
+    beast::get_lowest_layer(*m_ws).async_connect(
+        results,
+        [self = shared_from_this(), ws = m_ws, generation](beast::error_code ec,
+                                                           const boost::asio::ip::tcp::endpoint&) {
+            self->onConnect(generation, ec);
+        });
+}
+
+void TranscriptionClient::onConnect(unsigned generation, beast::error_code ec)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    if (ec) {
+        return fail("connect", ec);
+    }
+
+    // The websocket has its own timeouts once the handshake starts
+    beast::get_lowest_layer(*m_ws).expires_never();
+    beast::get_lowest_layer(*m_ws).socket().set_option(boost::asio::ip::tcp::no_delay(true));
+    m_ws->set_option(websocket::stream_base::timeout::suggested(beast::role_type::client));
+
+    m_ws->async_handshake(m_host + ":" + m_port, "/",
+                          [self = shared_from_this(), ws = m_ws, generation](beast::error_code ec) {
+                              self->onHandshake(generation, ec);
+                          });
+}
+
+void TranscriptionClient::onHandshake(unsigned generation, beast::error_code ec)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    if (ec) {
+        return fail("handshake", ec);
+    }
+
+    m_connecting = false;
+    m_connected = true;
+    m_reconnectAttempts = 0;
+
+    // Every connection starts out as plain PCM
+    m_encoder.setCodec(AudioCodec::Pcm16);
+    m_codec = AudioCodec::Pcm16;
+    m_serverResumes = false;
+
+    if (m_compressionEnabled || m_resumeEnabled) {
+        sendHello();
+        m_awaitingHello = true;
+        m_helloTimer.expires_after(HELLO_TIMEOUT);
+        m_helloTimer.async_wait([self = shared_from_this(), generation](beast::error_code ec) {
+            if (!ec && generation == self->m_generation && self->m_awaitingHello) {
+                self->startStreaming();
+            }
+        });
+    } else {
+        startStreaming();
+    }
+
+    if (m_connectionHandler && !m_shutdown) {
+        m_connectionHandler(true);
+    }
+    doRead(generation);
+}
+
+void TranscriptionClient::doRead(unsigned generation)
+{
+    m_ws->async_read(m_readBuffer,
+                     [self = shared_from_this(), ws = m_ws, generation](beast::error_code ec, std::size_t) {
+                         self->onRead(generation, ec);
+                     });
+}
+
+void TranscriptionClient::onRead(unsigned generation, beast::error_code ec)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    if (ec) {
+        return fail("read", ec);
+    }
+
+    if (m_ws->got_text()) {
+        handleTextMessage();
+    }
+    m_readBuffer.consume(m_readBuffer.size());
+
+    doRead(generation);
+}
+
+void TranscriptionClient::queueControl(Outgoing message)
+{
+    m_controlLane.push_back(std::move(message));
+    m_controlQueueDepth.store(m_controlLane.size(), std::memory_order_relaxed);
+    if (!m_writing) {
+        doWrite();
+    }
+}
+
+void TranscriptionClient::doWrite()
+{
+    if (!takeNextMessage()) {
+        m_writing = false;
+        return;
+    }
+
+    m_writing = true;
+    m_writeStarted = MetricsRegistry::enabled() ? std::chrono::steady_clock::now()
+                                                : std::chrono::steady_clock::time_point();
+    m_ws->binary(m_current.binary);
+    m_ws->async_write(boost::asio::buffer(m_current.data),
+                      [self = shared_from_this(), ws = m_ws, generation = m_generation](beast::error_code ec,
+                                                                                          std::size_t bytes) {
+                          self->onWrite(generation, ec, bytes);
+                      });
+}
+
+bool TranscriptionClient::takeNextMessage()
+{
+    if (!m_controlLane.empty()) {
+        m_current = std::move(m_controlLane.front());
+        m_controlLane.pop_front();
+        m_controlQueueDepth.store(m_controlLane.size(), std::memory_order_relaxed);
+        return true;
+    }
+    if (m_audioLane.empty()) {
+        return false;
+    }
+
+    // Tell a resuming server where the numbering continues: on a new
+    // connection, when resume was just switched on, or after a drop.
+    const std::uint64_t seq = m_audioLane.front().seq;
+    if (m_serverResumes && seq != m_wireSeq) {
+        const QJsonObject resume{
+            {"type", "audio_resume"},
+            {"stream", QString::fromStdString(m_streamId)},
+            {"seq", qint64(seq)}
+        };
+        m_current = Outgoing{toBytes(QJsonDocument(resume).toJson(QJsonDocument::Compact)), false};
+        m_wireSeq = seq;
+        return true;
+    }
+
+    encodeNextFrame();
+    return true;
+}
+
+void TranscriptionClient::encodeNextFrame()
+{
+    // Encoded only now, so a codec announced in the meantime already applies
+    ReplayFrame& frame = m_audioLane.front();
+    m_current = Outgoing{takeBuffer(), true, frame.seq};
+    m_encoder.encode(frame.samples.data(), frame.samples.size(), m_current.data);
+
+    m_audioMessages.fetch_add(1, std::memory_order_relaxed);
+    m_audioBytes.fetch_add(m_current.data.size(), std::memory_order_relaxed);
+    metrics().audioBytes.add(m_current.data.size());
+    m_pcmBytes.fetch_add(frame.samples.size() * sizeof(std::int16_t), std::memory_order_relaxed);
+
+    m_wireSeq = frame.seq + 1;
+    popAudio();
+}
+
+void TranscriptionClient::onWrite(unsigned generation, beast::error_code ec, std::size_t)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    if (ec) {
+        return fail("write", ec);
+    }
+
+    if (m_writeStarted != std::chrono::steady_clock::time_point()) {
+        metrics().write.record(std::chrono::steady_clock::now() - m_writeStarted);
+    }
+    if (m_current.seq != 0) {
+        m_lastWrittenSeq = std::max(m_lastWrittenSeq, m_current.seq);
+    }
+    if (m_current.binary && m_spareBuffers.size() < MAX_SPARE_BUFFERS) {
+        m_current.data.clear();
+        m_spareBuffers.push_back(std::move(m_current.data));
+    }
+    m_current = Outgoing{};
+
+    // Some slack, so capture is not woken for every single message
+    if (m_audioLane.size() <= m_audioCapacity / 2) {
+        notifyAudioSpace();
+    }
+    doWrite();
+}
+
+void TranscriptionClient::fail(const std::string& what, beast::error_code ec)
+{
+    // Completions still pending on this connection are ignored from now on
+    ++m_generation;
+
+    const bool wasConnected = m_connected.exchange(false);
+    m_connecting = false;
+    m_writing = false;
+    m_streaming = false;
+    m_awaitingHello = false;
+    m_helloTimer.cancel();
+    m_current = Outgoing{};
+    clearQueues();
+
+    if (m_ws) {
+        beast::error_code ignored;
+        beast::get_lowest_layer(*m_ws).socket().close(ignored);
+    }
+
+    if (m_shutdown) {
+        return;
+    }
+    // Only the first failure of a series, not every retry
+    if (m_errorHandler && (wasConnected || m_reconnectAttempts == 0)) {
+        m_errorHandler(what + ": " + ec.message());
+    }
+    if (wasConnected && m_connectionHandler) {
+        m_connectionHandler(false);
+    }
+    scheduleReconnect();
+}
+
+void TranscriptionClient::sendHello()
+{
+    QJsonArray codecs;
+    if (m_compressionEnabled) {
+        codecs.append(audioCodecName(AudioCodec::ImaAdpcm));
+        codecs.append(audioCodecName(AudioCodec::MuLaw));
+    }
+    codecs.append(audioCodecName(AudioCodec::Pcm16));
+
+    QJsonObject hello{
+        {"type", "hello"},
+        {"codecs", codecs},
+        {"sample_rate", m_sampleRate},
+        {"channels", 1}
+    };
+    if (m_resumeEnabled) {
+        hello.insert("stream", QString::fromStdString(m_streamId));
+        hello.insert("resume", true);
+    }
+    queueControl(Outgoing{toBytes(QJsonDocument(hello).toJson(QJsonDocument::Compact)), false});
+}
+
+void TranscriptionClient::handleTextMessage()
+{
+    m_messagesReceived.fetch_add(1, std::memory_order_relaxed);
+
+    // flat_buffer is contiguous, parse it in place
+    const auto data = m_readBuffer.data();
+    const QByteArray bytes = QByteArray::fromRawData(static_cast<const char*>(data.data()),
+                                                     qsizetype(data.size()));
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(bytes, &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        m_messagesMalformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const QJsonObject object = document.object();
+    const QString type = object.value("type").toString();
+
+    if (type == "transcribe") {
+        const QJsonValue content = object.value("content");
+        if (!content.isString()) {
+            m_messagesMalformed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        metrics().transcripts.add();
+        if (!m_inbox.push(TranscriptionMessage{TranscriptionMessage::Type::Transcript, content.toString()})) {
+            m_messagesDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (!m_notifyPending.exchange(true) && m_messagesReady && !m_shutdown) {
+            m_messagesReady();
+        }
+    } else if (type == "hello") {
+        handleHello(object);
+    } else {
+        m_messagesUnknown.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TranscriptionClient::handleHello(const QJsonObject& hello)
+{
+    const bool wasResuming = m_serverResumes;
+    m_serverResumes = m_resumeEnabled && hello.value("resume").toBool();
+
+    // Resume switched on mid-stream: number from the next message on
+    if (m_streaming && m_serverResumes && !wasResuming) {
+        m_wireSeq = 0;
+    }
+
+    AudioCodec codec;
+    const std::string name = hello.value("codec").toString().toStdString();
+    if (!audioCodecFromName(name, codec)) {
+        if (m_errorHandler && !m_shutdown) {
+            m_errorHandler("Server chose unknown audio codec: " + name);
+        }
+        if (m_awaitingHello) {
+            startStreaming();
+        }
+        return;
+    }
+
+    // Announce the switch in-band so the server knows exactly which binary
+    // message is the first one in the new codec.
+    const QJsonObject announce{
+        {"type", "audio_codec"},
+        {"codec", QString::fromLatin1(audioCodecName(codec))}
+    };
+    queueControl(Outgoing{toBytes(QJsonDocument(announce).toJson(QJsonDocument::Compact)), false});
+
+    m_encoder.setCodec(codec);
+    m_codec = codec;
+
+    if (m_awaitingHello) {
+        startStreaming();
+    }
+}
+
+std::vector<std::uint8_t> TranscriptionClient::takeBuffer()
+{
+    if (m_spareBuffers.empty()) {
+        return {};
+    }
+    std::vector<std::uint8_t> buffer = std::move(m_spareBuffers.back());
+    m_spareBuffers.pop_back();
+    return buffer;
+}
+
+std::vector<std::int16_t> TranscriptionClient::takeFrame()
+{
+    if (m_spareFrames.empty()) {
+        return {};
+    }
+    std::vector<std::int16_t> frame = std::move(m_spareFrames.back());
+    m_spareFrames.pop_back();
+    return frame;
+}
@@ -0,0 +1,304 @@
+#ifndef TRANSCRIPTION_CLIENT_H
+#define TRANSCRIPTION_CLIENT_H
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "AudioCodec.h"
+#include "SpscRingBuffer.h"
+
+// A server message decoded on the io thread, ready for display
+struct TranscriptionMessage {
+    enum class Type {
+        Transcript   // {"type":"transcribe","content":"..."}
+    };
+
+    Type type{Type::Transcript};
+    QString text;
+};
+
+// What TranscriptionClient does with audio when its send queue is full
+enum class OverflowPolicy {
+    DropOldest,    // keep the latest audio, the server catches up
+    DropNewest,    // keep what is queued, refuse the new message
+    BlockCapture   // stop pulling audio from capture until there is room
+};
+
+// How TranscriptionClient retries after losing the server. The first retry
+// is immediate, later ones back off exponentially; jitter is the fraction
+// of each delay that is random, so clients do not reconnect in lockstep.
+struct ReconnectPolicy {
+    std::chrono::milliseconds initialDelay{100};
+    std::chrono::milliseconds maxDelay{2000};
+    double multiplier{2.0};
+    double jitter{0.5};
+};
+
+// Websocket connection to the transcription server.
+//
+// Binary messages carry audio, text messages carry JSON. Audio is sent as
+// Pcm16 unless compression or resume is enabled, in which case the
+// extensions are negotiated after the handshake:
+//   client: {"type":"hello","codecs":["ima-adpcm","mulaw","pcm16"],"sample_rate":16000,"channels":1,
+//            "stream":"5f0c...","resume":true}
+//   server: {"type":"hello","codec":"ima-adpcm","resume":true}
+//   client: {"type":"audio_codec","codec":"ima-adpcm"}
+//   client: {"type":"audio_resume","stream":"5f0c...","seq":1234}
+// Binary messages after audio_codec use that codec. After audio_resume
+// they are numbered consecutively from its seq, so a server that still
+// knows the stream can drop audio it already has. The hello is only sent
+// when an extension is enabled, so servers without negotiation keep
+// getting the plain PCM they expect.
+//
+// Text messages go out ahead of any queued audio. Audio waits in a queue
+// of fixed capacity, in messages, and is encoded when it is written; what
+// happens when the queue is full is up to the OverflowPolicy. Under
+// BlockCapture sendAudio() itself never refuses audio: the capture side
+// asks audioQueueFull() before each frame and stops draining the capture
+// ring until the handler passed to setAudioSpaceHandler() is called.
+// Audio dropped from the queue still goes into the replay buffer, and a
+// resuming server is sent a fresh audio_resume across the gap.
+//
+// A lost connection is re-established on the io thread following the
+// ReconnectPolicy. The last few seconds of audio are kept and replayed on
+// the new connection: everything not yet written to the old one, or the
+// whole buffer when the server resumes streams.
+//
+// All socket work runs on the io_context's single thread, which is also
+// where the handlers are called. Handlers are set before connect().
+// connect(), shutdown() and the settings may be called from any thread;
+// sendAudio(), audioQueueFull() and sendText() only from the io thread.
+//
+// Incoming JSON is parsed on the io thread as well. Messages meant for
+// display are moved into a lock-free queue that one other thread drains
+// with consumeMessages() after the handler passed to
+// setMessagesReadyHandler() told it to; unknown and malformed messages are
+// counted and dropped without ever reaching it.
+class TranscriptionClient : public std::enable_shared_from_this<TranscriptionClient>
+{
+public:
+    using MessagesReadyHandler = std::function<void()>;
+    using ConnectionHandler = std::function<void(bool connected)>;
+    using ErrorHandler = std::function<void(const std::string& error)>;
+
+    struct Stats {
+        std::uint64_t audioMessages{0};
+        std::uint64_t audioBytes{0};  // encoded, as sent
+        std::uint64_t pcmBytes{0};    // what the same audio is as Pcm16
+        std::uint64_t messagesReceived{0};
+        std::uint64_t messagesUnknown{0};
+        std::uint64_t messagesMalformed{0};
+        std::uint64_t messagesDropped{0};  // the consumer fell behind
+        std::uint64_t reconnects{0};       // attempts after losing or missing the server
+        std::uint64_t audioReplayed{0};    // messages sent again after a reconnect
+        std::uint64_t audioLost{0};        // never sent, the replay buffer was full
+        std::uint64_t audioQueueDepth{0};  // messages waiting to be written
+        std::uint64_t audioQueueHighWater{0};
+        std::uint64_t audioDroppedOldest{0};
+        std::uint64_t audioDroppedNewest{0};
+        std::uint64_t captureBlocks{0};    // times capture was paused for room
+        std::uint64_t controlQueueDepth{0};
+    };
+
+    static constexpr std::chrono::milliseconds DEFAULT_REPLAY_DURATION{5000};
+    static constexpr std::size_t DEFAULT_AUDIO_QUEUE = 64;
+
+    TranscriptionClient(boost::asio::io_context& ioContext,
+                        const std::string& host,
+                        const std::string& port,
+                        int sampleRate = 16000);
+
+    // Called on the io thread whenever messages become available after the
+    // consumer has drained the queue.
+    void setMessagesReadyHandler(MessagesReadyHandler handler);
+    void setConnectionHandler(ConnectionHandler handler);
+    void setErrorHandler(ErrorHandler handler);
+    // Called on the io thread, never from within audioQueueFull(), once
+    // there is room again after it returned true.
+    void setAudioSpaceHandler(std::function<void()> handler);
+
+    // Connects and keeps reconnecting until shutdown().
+    void connect();
+    void shutdown();
+    bool isConnected() const;
+
+    void setReconnectPolicy(const ReconnectPolicy& policy);
+    void setReplayDuration(std::chrono::milliseconds duration);
+    void setAudioQueue(std::size_t capacity, OverflowPolicy policy);
+
+    // Take effect immediately when connected, otherwise on the next connect.
+    void setCompressionEnabled(bool enabled);
+    void setResumeEnabled(bool enabled);
+    AudioCodec audioCodec() const;
+    Stats stats() const;
+
+    // Returns false when the audio cannot be sent right now; it is kept for
+    // replay after the next connect then, or dropped by the OverflowPolicy.
+    bool sendAudio(const std::int16_t* samples, std::size_t count);
+    // Whether capture should hold back its audio for now; only ever true
+    // under BlockCapture. Io thread only.
+    bool audioQueueFull();
+    bool sendText(const std::string& message);
+
+    // Consumer side: hands every queued message to
+    // consume(TranscriptionMessage&&).
+    template <typename Fn>
+    void consumeMessages(Fn&& consume);
+
+private:
+    static constexpr std::size_t INBOX_MESSAGES = 256;
+
+    using WebSocket = boost::beast::websocket::stream<boost::beast::tcp_stream>;
+
+    struct Outgoing {
+        std::vector<std::uint8_t> data;
+        bool binary{true};
+        std::uint64_t seq{0};  // of audio messages
+    };
+
+    struct ReplayFrame {
+        std::uint64_t seq{0};
+        std::vector<std::int16_t> samples;
+    };
+
+    void startConnect();
+    void scheduleReconnect();
+    std::chrono::milliseconds nextReconnectDelay();
+    void startStreaming();
+    void remember(std::uint64_t seq, const std::int16_t* samples, std::size_t count);
+    bool queueAudio(std::uint64_t seq, const std::int16_t* samples, std::size_t count);
+    void pushAudio(std::uint64_t seq, const std::int16_t* samples, std::size_t count);
+    void popAudio();
+    void clearQueues();
+    void notifyAudioSpace();
+    bool takeNextMessage();
+    void encodeNextFrame();
+
+    void onResolve(unsigned generation, boost::beast::error_code ec,
+                   boost::asio::ip::tcp::resolver::results_type results);
+    void onConnect(unsigned generation, boost::beast::error_code ec);
+    void onHandshake(unsigned generation, boost::beast::error_code ec);
+    void doRead(unsigned generation);
+    void onRead(unsigned generation, boost::beast::error_code ec);
+    void queueControl(Outgoing message);
+    void doWrite();
+    void onWrite(unsigned generation, boost::beast::error_code ec, std::size_t bytes);
+    void fail(const std::string& what, boost::beast::error_code ec);
+    void sendHello();
+    void handleTextMessage();
+    void handleHello(const QJsonObject& hello);
+    std::vector<std::uint8_t> takeBuffer();
+    std::vector<std::int16_t> takeFrame();
+
+    boost::asio::io_context& m_ioContext;
+    boost::asio::ip::tcp::resolver m_resolver;
+    std::shared_ptr<WebSocket> m_ws;  // shared with its pending completions
+    boost::beast::flat_buffer m_readBuffer;
+    std::string m_host;
+    std::string m_port;
+    int m_sampleRate;
+
+    MessagesReadyHandler m_messagesReady;
+    ConnectionHandler m_connectionHandler;
+    ErrorHandler m_errorHandler;
+
+    // Bumped on every connect and shutdown so that completions of an older
+    // connection are ignored.
+    unsigned m_generation{0};
+    bool m_connecting{false};
+    bool m_writing{false};
+    std::atomic<bool> m_connected{false};
+    std::atomic<bool> m_shutdown{false};
+
+    boost::asio::steady_timer m_reconnectTimer;
+    ReconnectPolicy m_reconnectPolicy;
+    unsigned m_reconnectAttempts{0};  // since the last successful handshake
+    std::minstd_rand m_random;
+
+    // Audio is held back until the server answered the hello
+    boost::asio::steady_timer m_helloTimer;
+    bool m_awaitingHello{false};
+    bool m_streaming{false};
+
+    // Two lanes: control messages are always written first
+    std::deque<Outgoing> m_controlLane;
+    std::deque<ReplayFrame> m_audioLane;  // still PCM
+    Outgoing m_current;                   // being written
+    std::chrono::steady_clock::time_point m_writeStarted;  // only while recording metrics
+    std::size_t m_audioCapacity{DEFAULT_AUDIO_QUEUE};
+    OverflowPolicy m_overflowPolicy{OverflowPolicy::DropOldest};
+    bool m_audioBlocked{false};
+    std::function<void()> m_audioSpace;
+    std::vector<std::vector<std::uint8_t>> m_spareBuffers;
+
+    bool m_compressionEnabled{false};
+    bool m_resumeEnabled{false};
+    bool m_serverResumes{false};
+    std::string m_streamId;
+    AudioEncoder m_encoder;
+    std::atomic<AudioCodec> m_codec{AudioCodec::Pcm16};
+
+    std::atomic<std::uint64_t> m_audioMessages{0};
+    std::atomic<std::uint64_t> m_audioBytes{0};
+    std::atomic<std::uint64_t> m_pcmBytes{0};
+
+    std::deque<ReplayFrame> m_replay;
+    std::vector<std::vector<std::int16_t>> m_spareFrames;
+    std::size_t m_replaySamples{0};
+    std::size_t m_replayCapacity;     // in samples
+    std::uint64_t m_nextSeq{1};
+    std::uint64_t m_lastWrittenSeq{0};
+    std::uint64_t m_wireSeq{0};       // the server's idea of the next seq
+
+    std::atomic<std::uint64_t> m_reconnects{0};
+    std::atomic<std::uint64_t> m_audioReplayed{0};
+    std::atomic<std::uint64_t> m_audioLost{0};
+
+    std::atomic<std::uint64_t> m_audioQueueDepth{0};
+    std::atomic<std::uint64_t> m_audioQueueHighWater{0};
+    std::atomic<std::uint64_t> m_audioDroppedOldest{0};
+    std::atomic<std::uint64_t> m_audioDroppedNewest{0};
+    std::atomic<std::uint64_t> m_captureBlocks{0};
+    std::atomic<std::uint64_t> m_controlQueueDepth{0};
+
+    SpscRingBuffer<TranscriptionMessage, INBOX_MESSAGES> m_inbox;
+    std::atomic<bool> m_notifyPending{false};
+
+    std::atomic<std::uint64_t> m_messagesReceived{0};
+    std::atomic<std::uint64_t> m_messagesUnknown{0};
+    std::atomic<std::uint64_t> m_messagesMalformed{0};
+    std::atomic<std::uint64_t> m_messagesDropped{0};
+};
+
+template <typename Fn>
+void TranscriptionClient::consumeMessages(Fn&& consume)
+{
+    for (;;) {
+        while (TranscriptionMessage* message = m_inbox.front()) {
+            consume(std::move(*message));
+            m_inbox.release();
+        }
+
+        m_notifyPending.store(false);
+
+        // Same hand-off as AudioStreamer::consumeFrames(): a message
+        // published after the last front() is picked up here unless the
+        // producer already scheduled another drain for it.
+        if (m_inbox.empty() || m_notifyPending.exchange(true)) {
+            return;
+        }
+    }
+}
+
+#endif // TRANSCRIPTION_CLIENT_H
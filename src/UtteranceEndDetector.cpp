@@ -0,0 +1,51 @@
+#include "UtteranceEndDetector.h"
+
+UtteranceEndDetector::UtteranceEndDetector(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, [this]() {
+        emit utteranceEnded(m_text);
+    });
+}
+
+void UtteranceEndDetector::setConfig(const UtteranceEndConfig& config) {
+    m_config = config;
+}
+
+void UtteranceEndDetector::update(const QString& text) {
+    m_timer.stop();
+    m_text = text.simplified();
+
+    const int delay = delayFor(m_text);
+    if (delay >= 0) {
+        m_timer.start(delay);
+    }
+}
+
+void UtteranceEndDetector::reset() {
+    m_timer.stop();
+    m_text.clear();
+}
+
+int UtteranceEndDetector::delayFor(const QString& text) const {
+    if (text.isEmpty() || text.count(' ') + 1 < m_config.minWords) {
+        return -1;
+    }
+
+    // Transcribers often close a segment with a quote or bracket
+    qsizetype end = text.size() - 1;
+    while (end > 0 && (text[end] == '"' || text[end] == '\'' || text[end] == ')')) {
+        --end;
+    }
+
+    switch (text[end].unicode()) {
+    case '?':
+        return m_config.questionMarkMs;
+    case '.':
+    case '!':
+        return m_config.sentenceEndMs;
+    default:
+        return m_config.pauseMs;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef UTTERANCE_END_DETECTOR_H
+#define UTTERANCE_END_DETECTOR_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// Delays before an utterance counts as finished, in milliseconds since the
+// last transcript fragment.
+struct UtteranceEndConfig {
+    int pauseMs{900};          // no closing punctuation
+    int sentenceEndMs{350};    // ends with '.' or '!'
+    int questionMarkMs{0};     // ends with '?'
+    int minWords{3};           // shorter text is never considered a question
+};
+
+// Watches the text a Send would ask as transcript fragments extend it and
+// reports when the speaker has most likely finished: right after a question
+// mark, shortly after other sentence-final punctuation, or after a pause.
+// Every update restarts the wait, so ongoing speech never triggers it.
+class UtteranceEndDetector : public QObject
+{
+    Q_OBJECT
+public:
+    explicit UtteranceEndDetector(QObject *parent = nullptr);
+
+    void setConfig(const UtteranceEndConfig& config);
+    const UtteranceEndConfig& config() const { return m_config; }
+
+    // The full text so far, not just the new fragment; empty text resets.
+    void update(const QString& text);
+    void reset();
+
+    // How long to wait after text like this, or -1 when it is too short
+    int delayFor(const QString& text) const;
+
+signals:
+    void utteranceEnded(const QString& text);
+
+private:
+    UtteranceEndConfig m_config;
+    QTimer m_timer;
+    QString m_text;
+};
+
+#endif // UTTERANCE_END_DETECTOR_H
@@ -0,0 +1,187 @@
+#include "VoiceActivityDetector.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VAD_USE_SSE2
+#endif
+
+namespace {
+
+constexpr double SILENCE_DB = -120.0;
+constexpr double FULL_SCALE_SQUARED = 32768.0 * 32768.0;
+
+// How quickly the noise floor follows the level: fast downwards, slowly
+// upwards outside speech and very slowly during it, so a steady fan that
+// was mistaken for speech is eventually learned.
+constexpr double FLOOR_FALL_RATE = 0.3;
+constexpr double FLOOR_RISE_RATE = 0.05;
+constexpr double FLOOR_RISE_RATE_SPEECH = 0.005;
+
+} // namespace
+
+VoiceActivityDetector::VoiceActivityDetector(const VadConfig& config, int sampleRate)
+    : m_config(config),
+      m_sampleRate(sampleRate),
+      m_noiseFloorDb(config.energyThresholdDb - config.noiseMarginDb)
+{
+}
+
+void VoiceActivityDetector::setConfig(const VadConfig& config)
+{
+    m_config = config;
+}
+
+const VadConfig& VoiceActivityDetector::config() const
+{
+    return m_config;
+}
+
+void VoiceActivityDetector::setSampleRate(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+}
+
+void VoiceActivityDetector::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool VoiceActivityDetector::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+void VoiceActivityDetector::reset()
+{
+    m_inSpeech = false;
+    m_hangoverSamples = 0;
+    m_noiseFloorDb = m_config.energyThresholdDb - m_config.noiseMarginDb;
+
+    // Anything still held was never sent and stays counted as suppressed
+    m_preRollStart = 0;
+    m_preRollCount = 0;
+    m_preRollSamples = 0;
+}
+
+VoiceActivityDetector::Stats VoiceActivityDetector::stats() const
+{
+    Stats stats;
+    stats.framesSent = m_framesSent.load(std::memory_order_relaxed);
+    stats.framesSuppressed = m_framesSuppressed.load(std::memory_order_relaxed);
+    stats.speechSegments = m_speechSegments.load(std::memory_order_relaxed);
+    return stats;
+}
+
+VoiceActivityDetector::Features VoiceActivityDetector::analyze(const std::int16_t* samples, std::size_t count)
+{
+    Features features;
+    features.energyDb = SILENCE_DB;
+    if (count == 0) {
+        return features;
+    }
+
+    std::uint64_t sumSquares = 0;
+    std::uint64_t crossings = 0;
+    std::size_t i = 0;
+
+#ifdef VAD_USE_SSE2
+    // Eight samples per step. -32768 is clamped so a pair of squares summed
+    // by madd cannot overflow int32; sign changes between neighbours are
+    // found by xor-ing the block with itself shifted by one sample.
+    const __m128i minValue = _mm_set1_epi16(-32767);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i energy = _mm_setzero_si128();
+    __m128i signChanges = _mm_setzero_si128();
+
+    for (; i + 9 <= count; i += 8) {
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i + 1));
+
+        const __m128i clamped = _mm_max_epi16(current, minValue);
+        const __m128i squares = _mm_madd_epi16(clamped, clamped);
+        energy = _mm_add_epi64(energy, _mm_unpacklo_epi32(squares, zero));
+        energy = _mm_add_epi64(energy, _mm_unpackhi_epi32(squares, zero));
+
+        const __m128i changed = _mm_srai_epi16(_mm_xor_si128(current, next), 15);
+        signChanges = _mm_sub_epi32(signChanges, _mm_madd_epi16(changed, ones));
+    }
+
+    alignas(16) std::uint64_t energyLanes[2];
+    alignas(16) std::uint32_t crossingLanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(energyLanes), energy);
+    _mm_store_si128(reinterpret_cast<__m128i*>(crossingLanes), signChanges);
+    sumSquares = energyLanes[0] + energyLanes[1];
+    crossings = std::uint64_t(crossingLanes[0]) + crossingLanes[1] + crossingLanes[2] + crossingLanes[3];
+#endif
+
+    for (; i < count; ++i) {
+        const std::int32_t sample = std::max<std::int32_t>(samples[i], -32767);
+        sumSquares += std::uint64_t(sample * sample);
+        if (i + 1 < count && ((samples[i] ^ samples[i + 1]) < 0)) {
+            ++crossings;
+        }
+    }
+
+    const double meanSquare = double(sumSquares) / double(count);
+    if (meanSquare > 0.0) {
+        features.energyDb = std::max(SILENCE_DB, 10.0 * std::log10(meanSquare / FULL_SCALE_SQUARED));
+    }
+    if (count > 1) {
+        features.zeroCrossingRate = double(crossings) / double(count - 1);
+    }
+    return features;
+}
+
+bool VoiceActivityDetector::classify(const Features& features)
+{
+    const double threshold = std::max(m_config.energyThresholdDb,
+                                      m_noiseFloorDb + m_config.noiseMarginDb);
+    const bool speech = features.energyDb >= threshold &&
+                        (features.zeroCrossingRate <= m_config.maxZeroCrossingRate ||
+                         features.energyDb >= m_config.loudOverrideDb);
+
+    double rate = FLOOR_RISE_RATE_SPEECH;
+    if (features.energyDb < m_noiseFloorDb) {
+        rate = FLOOR_FALL_RATE;
+    } else if (!speech) {
+        rate = FLOOR_RISE_RATE;
+    }
+    m_noiseFloorDb += rate * (features.energyDb - m_noiseFloorDb);
+
+    return speech;
+}
+
+void VoiceActivityDetector::holdForPreRoll(const std::uint8_t* data, std::size_t bytes)
+{
+    const std::size_t wanted = samplesForMs(m_config.preRollMs);
+    if (wanted == 0) {
+        return;
+    }
+
+    if (m_preRollCount == PRE_ROLL_SLOTS) {
+        m_preRollSamples -= m_preRoll[m_preRollStart].samples;
+        m_preRollStart = (m_preRollStart + 1) % PRE_ROLL_SLOTS;
+        --m_preRollCount;
+    }
+
+    // assign() reuses the slot's capacity once the ring has filled up
+    HeldFrame& slot = m_preRoll[(m_preRollStart + m_preRollCount) % PRE_ROLL_SLOTS];
+    slot.data.assign(data, data + bytes);
+    slot.samples = bytes / sizeof(std::int16_t);
+    m_preRollSamples += slot.samples;
+    ++m_preRollCount;
+
+    // Keep only as many of the newest frames as cover the pre-roll
+    while (m_preRollCount > 1 && m_preRollSamples - m_preRoll[m_preRollStart].samples >= wanted) {
+        m_preRollSamples -= m_preRoll[m_preRollStart].samples;
+        m_preRollStart = (m_preRollStart + 1) % PRE_ROLL_SLOTS;
+        --m_preRollCount;
+    }
+}
+
+std::size_t VoiceActivityDetector::samplesForMs(int ms) const
+{
+    return ms > 0 ? std::size_t(m_sampleRate) * std::size_t(ms) / 1000 : 0;
+}
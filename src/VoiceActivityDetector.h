@@ -0,0 +1,143 @@
+#ifndef VOICE_ACTIVITY_DETECTOR_H
+#define VOICE_ACTIVITY_DETECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Thresholds for VoiceActivityDetector. Levels are in dBFS of the frame's
+// RMS, durations in milliseconds of audio.
+struct VadConfig {
+    double energyThresholdDb{-45.0};   // never speech below this level
+    double noiseMarginDb{8.0};         // speech must be this far above the noise floor
+    double maxZeroCrossingRate{0.30};  // hiss and fans cross zero more often than voice
+    double loudOverrideDb{-28.0};      // louder frames count as speech regardless of ZCR
+    int hangoverMs{400};               // keep sending this long after speech stops
+    int preRollMs{250};                // audio sent ahead of a detected onset
+};
+
+// Energy/zero-crossing voice activity detector for mono Int16 PCM, used to
+// keep silence off the transcription link.
+//
+// process() is called with every captured frame in order and forwards the
+// frames that should be sent. Frames that arrive shortly before an onset are
+// held in a small pre-roll ring and sent ahead of it, and a hangover keeps
+// trailing syllables after the level drops. Apart from stats() and
+// setEnabled() the detector must only be used from one thread.
+class VoiceActivityDetector
+{
+public:
+    struct Features {
+        double energyDb{0.0};
+        double zeroCrossingRate{0.0};
+    };
+
+    struct Stats {
+        std::uint64_t framesSent{0};
+        std::uint64_t framesSuppressed{0};
+        std::uint64_t speechSegments{0};
+    };
+
+    explicit VoiceActivityDetector(const VadConfig& config = VadConfig(), int sampleRate = 16000);
+
+    void setConfig(const VadConfig& config);
+    const VadConfig& config() const;
+    void setSampleRate(int sampleRate);
+
+    // When disabled every frame is passed through and counted as sent.
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void reset();
+    Stats stats() const;
+
+    // Level and zero-crossing rate of a block of samples; SSE2 when available.
+    static Features analyze(const std::int16_t* samples, std::size_t count);
+
+    // Classifies one frame and calls send(const std::uint8_t* data, std::size_t bytes)
+    // for each frame that should go out, pre-roll first.
+    template <typename Send>
+    void process(const std::uint8_t* data, std::size_t bytes, Send&& send);
+
+private:
+    static constexpr std::size_t PRE_ROLL_SLOTS = 16;
+
+    struct HeldFrame {
+        std::vector<std::uint8_t> data;
+        std::size_t samples{0};
+    };
+
+    bool classify(const Features& features);
+    void holdForPreRoll(const std::uint8_t* data, std::size_t bytes);
+    std::size_t samplesForMs(int ms) const;
+
+    VadConfig m_config;
+    int m_sampleRate;
+    std::atomic<bool> m_enabled{true};
+    bool m_wasEnabled{true};
+
+    bool m_inSpeech{false};
+    std::size_t m_hangoverSamples{0};
+    double m_noiseFloorDb;
+
+    std::array<HeldFrame, PRE_ROLL_SLOTS> m_preRoll;
+    std::size_t m_preRollStart{0};
+    std::size_t m_preRollCount{0};
+    std::size_t m_preRollSamples{0};
+
+    std::atomic<std::uint64_t> m_framesSent{0};
+    std::atomic<std::uint64_t> m_framesSuppressed{0};
+    std::atomic<std::uint64_t> m_speechSegments{0};
+};
+
+template <typename Send>
+void VoiceActivityDetector::process(const std::uint8_t* data, std::size_t bytes, Send&& send)
+{
+    const bool enabled = m_enabled.load(std::memory_order_relaxed);
+    if (enabled != m_wasEnabled) {
+        m_wasEnabled = enabled;
+        reset();
+    }
+
+    if (!enabled) {
+        m_framesSent.fetch_add(1, std::memory_order_relaxed);
+        send(data, bytes);
+        return;
+    }
+
+    const std::size_t samples = bytes / sizeof(std::int16_t);
+    const Features features = analyze(reinterpret_cast<const std::int16_t*>(data), samples);
+
+    if (classify(features)) {
+        if (!m_inSpeech) {
+            m_inSpeech = true;
+            m_speechSegments.fetch_add(1, std::memory_order_relaxed);
+
+            // The held frames were counted as suppressed when they arrived
+            for (; m_preRollCount > 0; --m_preRollCount) {
+                const HeldFrame& held = m_preRoll[m_preRollStart];
+                send(held.data.data(), held.data.size());
+                m_preRollStart = (m_preRollStart + 1) % PRE_ROLL_SLOTS;
+                m_framesSuppressed.fetch_sub(1, std::memory_order_relaxed);
+                m_framesSent.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_preRollSamples = 0;
+        }
+        m_hangoverSamples = samplesForMs(m_config.hangoverMs);
+    } else if (m_inSpeech && m_hangoverSamples > 0) {
+        m_hangoverSamples -= std::min(m_hangoverSamples, samples);
+    } else {
+        m_inSpeech = false;
+        holdForPreRoll(data, bytes);
+        m_framesSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_framesSent.fetch_add(1, std::memory_order_relaxed);
+    send(data, bytes);
+}
+
+#endif // VOICE_ACTIVITY_DETECTOR_H
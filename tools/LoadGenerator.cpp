@@ -0,0 +1,336 @@
+// Drives the app's request path (HyniCore -> ChatRequestScheduler ->
+// ChatAPIWorker) at a target arrival rate and reports throughput and
+// latency percentiles. Meant to run against qhyni_mock_llm:
+//
+//   qhyni_mock_llm --latency-ms 400 --tokens-per-sec 80 &
+//   qhyni_loadgen --rate 5 --duration 30 --workers 3 --queue 8
+//
+// Arrivals are open loop: questions are submitted on schedule whether or
+// not earlier ones were answered, so a saturated pool shows up as drops
+// and growing latency instead of a lower offered rate. Every question is
+// unique, so the response cache never answers one. Progress goes to stderr
+// every second and the report is one JSON object on stdout.
+//
+// Answers have to stream for --url to take effect; the non-streaming
+// fallback through hyni::chat_api always talks to the real provider.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include "HyniCore.h"
+#include "Metrics.h"
+#include "ProviderConfig.h"
+
+namespace {
+
+constexpr const char* DEFAULT_URL = "http://127.0.0.1:8089/v1/chat/completions";
+constexpr const char* DUMMY_API_KEY = "qhyni-loadgen";
+constexpr int PROGRESS_INTERVAL_MS = 1000;
+// How long answers still in flight are awaited after the last arrival
+constexpr int DRAIN_TIMEOUT_MS = 60000;
+
+QJsonObject latencySummary(const LatencyHistogram& histogram) {
+    const LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    const auto ms = [](double nanos) { return nanos / 1e6; };
+    return {
+        {"count", qint64(snapshot.count)},
+        {"mean_ms", ms(snapshot.meanNanos())},
+        {"p50_ms", ms(double(snapshot.quantile(0.50)))},
+        {"p90_ms", ms(double(snapshot.quantile(0.90)))},
+        {"p99_ms", ms(double(snapshot.quantile(0.99)))},
+        {"max_ms", ms(double(snapshot.maxNanos))}
+    };
+}
+
+class LoadGenerator
+{
+public:
+    struct Settings {
+        double rate{2.0};        // arrivals per second
+        int durationSec{30};
+        int maxRequests{0};      // 0: as many as fit in the duration
+        bool poisson{false};
+        QImage image;            // asked instead of text when set
+    };
+
+    LoadGenerator(HyniCore* core, const Settings& settings)
+        : m_core(core),
+        m_settings(settings)
+    {
+        QObject::connect(core, &HyniCore::partialResponseReceived, &m_context, [this](quint64 requestId, const QString&) {
+            auto it = m_requests.find(requestId);
+            if (it != m_requests.end() && !it->streamed) {
+                it->streamed = true;
+                m_firstToken.recordNanos(std::uint64_t(it->submitted.nsecsElapsed()));
+            }
+        });
+        QObject::connect(core, &HyniCore::responseReceived, &m_context, [this](quint64 requestId, const QString&, bool) {
+            auto it = m_requests.find(requestId);
+            if (it != m_requests.end()) {
+                m_answer.recordNanos(std::uint64_t(it->submitted.nsecsElapsed()));
+                ++m_completed;
+            }
+        });
+        QObject::connect(core, &HyniCore::errorOccurred, &m_context, [this](quint64, const QString& error) {
+            // QNetworkReply reports the HTTP reason phrase
+            if (error.contains("Too Many Requests")) {
+                ++m_rateLimited;
+            } else {
+                ++m_errors;
+                if (m_lastError != error) {
+                    m_lastError = error;
+                    qWarning() << "Request failed:" << error;
+                }
+            }
+        });
+        QObject::connect(core, &HyniCore::requestFinished, &m_context, [this](quint64 requestId) {
+            m_requests.remove(requestId);
+            finishIfDrained();
+        });
+        QObject::connect(core, &HyniCore::needApiKey, &m_context, []() {
+            qCritical() << "No API key for the selected provider";
+            QCoreApplication::exit(1);
+        });
+        QObject::connect(core, &HyniCore::warning, &m_context, [](const QString& message) {
+            qWarning() << message;
+        });
+
+        m_arrivals.setSingleShot(true);
+        m_arrivals.setTimerType(Qt::PreciseTimer);
+        QObject::connect(&m_arrivals, &QTimer::timeout, &m_context, [this]() { arrive(); });
+
+        m_progress.setInterval(PROGRESS_INTERVAL_MS);
+        QObject::connect(&m_progress, &QTimer::timeout, &m_context, [this]() { printProgress(); });
+
+        m_drainTimeout.setSingleShot(true);
+        m_drainTimeout.setInterval(DRAIN_TIMEOUT_MS);
+        QObject::connect(&m_drainTimeout, &QTimer::timeout, &m_context, [this]() {
+            qWarning() << m_requests.size() << "requests still in flight, giving up on them";
+            finish();
+        });
+    }
+
+    void start() {
+        m_clock.start();
+        m_nextArrivalNs = 0;
+        m_progress.start();
+        arrive();
+    }
+
+    // One JSON object with the whole run
+    QJsonObject report() const {
+        const double seconds = std::max(m_elapsedNs, qint64(1)) / 1e9;
+        return {
+            {"offered_rate", m_settings.rate},
+            {"seconds", seconds},
+            {"sent", qint64(m_sent)},
+            {"dropped", qint64(m_dropped)},
+            {"completed", qint64(m_completed)},
+            {"errors", qint64(m_errors)},
+            {"rate_limited", qint64(m_rateLimited)},
+            {"abandoned", qint64(m_requests.size())},
+            {"throughput", m_completed / seconds},
+            {"first_token", latencySummary(m_firstToken)},
+            {"answer", latencySummary(m_answer)}
+        };
+    }
+
+private:
+    struct Request {
+        QElapsedTimer submitted;
+        bool streamed{false};
+    };
+
+    bool sending() const {
+        if (m_settings.maxRequests > 0 && m_sent + m_dropped >= quint64(m_settings.maxRequests)) {
+            return false;
+        }
+        return m_clock.nsecsElapsed() < qint64(m_settings.durationSec) * 1000000000LL;
+    }
+
+    // Submits everything that is due, so a late timer doesn't lower the rate
+    void arrive() {
+        while (sending() && m_clock.nsecsElapsed() >= m_nextArrivalNs) {
+            submitOne();
+            m_nextArrivalNs += nextInterval();
+        }
+        if (!sending()) {
+            m_draining = true;
+            m_drainTimeout.start();
+            finishIfDrained();
+            return;
+        }
+        const qint64 waitNs = m_nextArrivalNs - m_clock.nsecsElapsed();
+        m_arrivals.start(int(std::max(waitNs, qint64(0)) / 1000000));
+    }
+
+    qint64 nextInterval() {
+        const double meanNs = 1e9 / m_settings.rate;
+        if (!m_settings.poisson) {
+            return qint64(meanNs);
+        }
+        std::exponential_distribution<double> interval(1.0 / meanNs);
+        return qint64(interval(m_random));
+    }
+
+    void submitOne() {
+        const QVector<HyniCore::Submission> submissions = m_settings.image.isNull()
+            ? m_core->askText(QString("Load test question %1: explain how a hash map resolves collisions.")
+                                  .arg(m_sent + m_dropped + 1))
+            : m_core->askImage(m_settings.image);
+        for (const HyniCore::Submission& submission : submissions) {
+            if (submission.requestId == 0) {
+                ++m_dropped;
+                continue;
+            }
+            Request request;
+            request.submitted.start();
+            m_requests.insert(submission.requestId, request);
+            ++m_sent;
+        }
+    }
+
+    void printProgress() {
+        std::fprintf(stderr, "%.1fs: %llu sent, %llu dropped, %llu completed, %llu errors, %llu rate limited, %lld in flight\n",
+                     m_clock.nsecsElapsed() / 1e9,
+                     static_cast<unsigned long long>(m_sent),
+                     static_cast<unsigned long long>(m_dropped),
+                     static_cast<unsigned long long>(m_completed),
+                     static_cast<unsigned long long>(m_errors),
+                     static_cast<unsigned long long>(m_rateLimited),
+                     static_cast<long long>(m_requests.size()));
+    }
+
+    void finishIfDrained() {
+        if (m_draining && m_requests.isEmpty()) {
+            finish();
+        }
+    }
+
+    void finish() {
+        m_elapsedNs = m_clock.nsecsElapsed();
+        m_progress.stop();
+        m_drainTimeout.stop();
+        printProgress();
+        QCoreApplication::quit();
+    }
+
+    QObject m_context;
+    HyniCore* m_core;
+    Settings m_settings;
+    std::mt19937 m_random{std::random_device{}()};
+
+    QElapsedTimer m_clock;
+    qint64 m_nextArrivalNs{0};
+    qint64 m_elapsedNs{0};
+    bool m_draining{false};
+    QTimer m_arrivals;
+    QTimer m_progress;
+    QTimer m_drainTimeout;
+
+    QHash<quint64, Request> m_requests;
+    quint64 m_sent{0};
+    quint64 m_dropped{0};
+    quint64 m_completed{0};
+    quint64 m_errors{0};
+    quint64 m_rateLimited{0};
+    QString m_lastError;
+
+    // Local, so they count regardless of MetricsRegistry::enabled()
+    LatencyHistogram m_firstToken;
+    LatencyHistogram m_answer;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qhyni_loadgen");
+    QCoreApplication::setApplicationVersion(QHYNI_COMMIT_HASH);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Drives Qhyni's request path at a target rate and reports latency");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOptions({
+        {"url", "Chat-completions endpoint to load.", "url", DEFAULT_URL},
+        {"provider", "openai or deepseek; picks the request format.", "provider", "openai"},
+        {"rate", "Questions per second.", "rate", "2"},
+        {"poisson", "Exponentially distributed gaps instead of a fixed interval."},
+        {"duration", "Seconds to keep submitting.", "seconds", "30"},
+        {"requests", "Stop after this many questions.", "count", "0"},
+        {"workers", "Concurrent API requests.", "count", "3"},
+        {"queue", "Requests that may wait for a free worker.", "count", "8"},
+        {"image", "Ask about this image instead of text.", "path"},
+    });
+    parser.process(app);
+
+    const double rate = parser.value("rate").toDouble();
+    if (rate <= 0.0) {
+        qCritical() << "--rate must be positive";
+        return 2;
+    }
+    const QString providerName = parser.value("provider");
+    if (providerName != "openai" && providerName != "deepseek") {
+        qCritical() << "Unknown provider" << providerName;
+        return 2;
+    }
+    const auto provider = providerName == "deepseek" ? hyni::chat_api::API_PROVIDER::DeepSeek
+                                                     : hyni::chat_api::API_PROVIDER::OpenAI;
+
+    LoadGenerator::Settings settings;
+    settings.rate = rate;
+    settings.durationSec = std::max(parser.value("duration").toInt(), 1);
+    settings.maxRequests = std::max(parser.value("requests").toInt(), 0);
+    settings.poisson = parser.isSet("poisson");
+    if (parser.isSet("image")) {
+        settings.image = QImage(parser.value("image"));
+        if (settings.image.isNull()) {
+            qCritical() << "Cannot load image" << parser.value("image");
+            return 2;
+        }
+    }
+
+    // Read by providerEndpoint() in the worker threads
+    qputenv(CHAT_API_URL_ENV, parser.value("url").toUtf8());
+
+    HyniCore::Options options;
+    options.transcription = false;
+    options.captureAudio = false;
+    options.workerCount = std::max(parser.value("workers").toInt(), 1);
+    options.queueCapacity = std::max(parser.value("queue").toInt(), 0);
+
+    try {
+        HyniCore core(options);
+        core.setProvider(provider);
+        core.setQuestionType(hyni::chat_api::QUESTION_TYPE::General);
+        core.setStreamingEnabled(true);
+        core.setCacheEnabled(false);
+
+        // The mock only checks that a key is sent
+        const QString apiKey = qEnvironmentVariable(providerEndpoint(provider).apiKeyEnv);
+        core.setAPIKey(apiKey.isEmpty() ? QString(DUMMY_API_KEY) : apiKey);
+
+        LoadGenerator generator(&core, settings);
+        core.start();
+        generator.start();
+        const int result = app.exec();
+
+        core.cancelAll();
+        std::fputs(QJsonDocument(generator.report()).toJson(QJsonDocument::Compact).constData(), stdout);
+        std::fputc('\n', stdout);
+        return result;
+    } catch (const std::exception& e) {
+        qCritical() << "Fatal error:" << e.what();
+        return -1;
+    }
+}
@@ -0,0 +1,477 @@
+// Stand-in for the OpenAI/DeepSeek chat-completions endpoint, for measuring
+// the request path under load without paying for provider calls. Point the
+// app at it with QHYNI_CHAT_API_URL=http://127.0.0.1:8089/v1/chat/completions
+// (see ProviderConfig.h) and drive it with qhyni_loadgen.
+//
+// Usage: qhyni_mock_llm [--port 8089] [--latency-ms 400]
+//                       [--latency-dist fixed|uniform|exponential|lognormal]
+//                       [--latency-spread 0.5] [--tokens 200]
+//                       [--tokens-per-sec 60] [--error-rate 0.0]
+//                       [--rate-limit 0.0] [--max-concurrent 0]
+//                       [--images accept|reject] [--require-key yes|no]
+//                       [--seed 1]
+//
+// Every request waits for a time to first token drawn from the latency
+// distribution (--latency-ms is its median; --latency-spread is the
+// relative half-width for uniform and sigma for lognormal), then the
+// answer is produced at --tokens-per-sec, 0 meaning all at once. Requests
+// with "stream": true get server-sent events in the provider's chunk
+// format, ending with "data: [DONE]"; others get one chat.completion
+// object once the whole answer would have been generated. The answer is
+// --tokens long, or max_tokens if that is smaller.
+//
+// A fraction of requests fails with 500 (--error-rate) or 429 and a
+// Retry-After header (--rate-limit); with --max-concurrent every request
+// beyond that many in flight is refused with 429, like a provider's
+// concurrency limit. Images in image_url parts must be base64 data URLs
+// and are decoded to check them; --images reject answers them with 400 as
+// a text-only model does. Totals are printed every second while requests
+// arrive.
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+constexpr std::uint64_t MAX_BODY_BYTES = 64 * 1024 * 1024;
+
+enum class LatencyDistribution { Fixed, Uniform, Exponential, LogNormal };
+
+struct Options {
+    unsigned short port{8089};
+    double latencyMs{400.0};
+    LatencyDistribution distribution{LatencyDistribution::LogNormal};
+    double spread{0.5};
+    int tokens{200};
+    double tokensPerSec{60.0};
+    double errorRate{0.0};
+    double rateLimit{0.0};
+    int maxConcurrent{0};    // 0: unlimited
+    bool acceptImages{true};
+    bool requireKey{true};
+    unsigned seed{1};
+};
+
+struct Totals {
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> completed{0};
+    std::atomic<std::uint64_t> streamed{0};
+    std::atomic<std::uint64_t> rateLimited{0};
+    std::atomic<std::uint64_t> serverErrors{0};
+    std::atomic<std::uint64_t> badRequests{0};
+    std::atomic<std::uint64_t> aborted{0};   // client went away mid-answer
+    std::atomic<std::uint64_t> images{0};
+    std::atomic<std::uint64_t> imageBytes{0};
+    std::atomic<std::uint64_t> tokens{0};
+    std::atomic<int> inFlight{0};
+    std::atomic<int> peakInFlight{0};
+};
+
+Totals totals;
+std::mutex outputMutex;
+
+void log(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+// What a model would say, cycled through word by word
+const char* const WORDS[] = {
+    "The", "idea", "is", "to", "keep", "the", "lowest", "price", "seen", "so", "far", "and",
+    "compare", "selling", "today", "against", "the", "best", "profit.", "\n\n```cpp\n",
+    "int", "maxProfit(const", "std::vector<int>&", "prices)", "{\n", "    int", "best", "=", "0;\n",
+    "    for", "(int", "price", ":", "prices)", "{", "...", "}\n", "}\n```\n\n", "Time:", "O(n),",
+    "space:", "O(1)."
+};
+constexpr int WORD_COUNT = int(sizeof(WORDS) / sizeof(WORDS[0]));
+
+std::string token(int index) {
+    std::string word = WORDS[index % WORD_COUNT];
+    if (word.back() != '\n') {
+        word += ' ';
+    }
+    return word;
+}
+
+std::string toText(const QJsonObject& object) {
+    return QJsonDocument(object).toJson(QJsonDocument::Compact).toStdString();
+}
+
+std::chrono::microseconds firstTokenDelay(const Options& options, std::mt19937& random) {
+    double ms = options.latencyMs;
+    switch (options.distribution) {
+    case LatencyDistribution::Fixed:
+        break;
+    case LatencyDistribution::Uniform:
+        ms *= std::uniform_real_distribution<double>(1.0 - options.spread, 1.0 + options.spread)(random);
+        break;
+    case LatencyDistribution::Exponential:
+        ms = std::exponential_distribution<double>(1.0 / options.latencyMs)(random);
+        break;
+    case LatencyDistribution::LogNormal:
+        ms = std::lognormal_distribution<double>(std::log(options.latencyMs), options.spread)(random);
+        break;
+    }
+    return std::chrono::microseconds(std::int64_t(std::max(ms, 0.0) * 1000.0));
+}
+
+void noteInFlight(int count) {
+    int peak = totals.peakInFlight.load();
+    while (count > peak && !totals.peakInFlight.compare_exchange_weak(peak, count)) {
+    }
+}
+
+class InFlight
+{
+public:
+    InFlight() : m_count(totals.inFlight.fetch_add(1) + 1) { noteInFlight(m_count); }
+    ~InFlight() { totals.inFlight.fetch_sub(1); }
+    int count() const { return m_count; }
+
+private:
+    int m_count;
+};
+
+template <typename Request>
+void sendJson(tcp::socket& socket, const Request& request, http::status status,
+              const QJsonObject& body, int retryAfter = 0) {
+    http::response<http::string_body> response{status, request.version()};
+    response.set(http::field::content_type, "application/json");
+    if (retryAfter > 0) {
+        response.set(http::field::retry_after, std::to_string(retryAfter));
+    }
+    response.keep_alive(request.keep_alive());
+    response.body() = toText(body);
+    response.prepare_payload();
+    http::write(socket, response);
+}
+
+QJsonObject errorBody(const QString& message, const QString& type) {
+    return QJsonObject{{"error", QJsonObject{{"message", message}, {"type", type}}}};
+}
+
+// Counts and checks every image part; the error for the first unusable one
+QString checkImages(const QJsonArray& messages) {
+    for (const QJsonValue& message : messages) {
+        const QJsonValue content = message.toObject().value("content");
+        if (!content.isArray()) {
+            continue;
+        }
+        for (const QJsonValue& part : content.toArray()) {
+            const QJsonObject object = part.toObject();
+            if (object.value("type").toString() != "image_url") {
+                continue;
+            }
+            const QString url = object.value("image_url").toObject().value("url").toString();
+            if (url.startsWith("http://") || url.startsWith("https://")) {
+                totals.images.fetch_add(1);
+                continue;
+            }
+            const qsizetype comma = url.indexOf(',');
+            if (!url.startsWith("data:image/") || comma < 0 || !url.left(comma).endsWith(";base64")) {
+                return "image_url must be an http(s) or base64 data:image URL";
+            }
+            const auto decoded = QByteArray::fromBase64Encoding(url.mid(comma + 1).toLatin1(),
+                                                                QByteArray::AbortOnBase64DecodingErrors);
+            if (!decoded || decoded.decoded.isEmpty()) {
+                return "image_url does not contain valid base64";
+            }
+            totals.images.fetch_add(1);
+            totals.imageBytes.fetch_add(std::uint64_t(decoded.decoded.size()));
+        }
+    }
+    return QString();
+}
+
+bool hasImage(const QJsonArray& messages) {
+    for (const QJsonValue& message : messages) {
+        const QJsonValue content = message.toObject().value("content");
+        for (const QJsonValue& part : content.toArray()) {
+            if (part.toObject().value("type").toString() == "image_url") {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename Request>
+void answer(tcp::socket& socket, const Request& request, const Options& options, std::mt19937& random) {
+    const auto received = std::chrono::steady_clock::now();
+    totals.requests.fetch_add(1);
+    InFlight inFlight;
+
+    const std::string auth(request[http::field::authorization]);
+    if (options.requireKey && auth.rfind("Bearer ", 0) != 0) {
+        totals.badRequests.fetch_add(1);
+        sendJson(socket, request, http::status::unauthorized,
+                 errorBody("Missing bearer token", "invalid_request_error"));
+        return;
+    }
+
+    QJsonParseError parseError;
+    const QJsonObject body = QJsonDocument::fromJson(QByteArray::fromStdString(request.body()), &parseError).object();
+    const QJsonArray messages = body.value("messages").toArray();
+    if (parseError.error != QJsonParseError::NoError || messages.isEmpty()) {
+        totals.badRequests.fetch_add(1);
+        sendJson(socket, request, http::status::bad_request,
+                 errorBody("Request body must be JSON with a non-empty messages array", "invalid_request_error"));
+        return;
+    }
+
+    const QString imageError = !options.acceptImages && hasImage(messages)
+        ? QString("This model does not accept image input")
+        : checkImages(messages);
+    if (!imageError.isEmpty()) {
+        totals.badRequests.fetch_add(1);
+        sendJson(socket, request, http::status::bad_request, errorBody(imageError, "invalid_request_error"));
+        return;
+    }
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    if ((options.maxConcurrent > 0 && inFlight.count() > options.maxConcurrent) ||
+        chance(random) < options.rateLimit) {
+        totals.rateLimited.fetch_add(1);
+        sendJson(socket, request, http::status::too_many_requests,
+                 errorBody("Rate limit reached, retry after 1s", "rate_limit_error"), 1);
+        return;
+    }
+    const bool fail = chance(random) < options.errorRate;
+
+    std::this_thread::sleep_until(received + firstTokenDelay(options, random));
+
+    if (fail) {
+        totals.serverErrors.fetch_add(1);
+        sendJson(socket, request, http::status::internal_server_error,
+                 errorBody("The server had an error while processing your request", "server_error"));
+        return;
+    }
+
+    const int maxTokens = body.value("max_tokens").toInt(options.tokens);
+    const int count = std::max(1, std::min(options.tokens, maxTokens));
+    const QString model = body.value("model").toString("mock");
+    const QString id = QString("chatcmpl-mock-%1").arg(totals.requests.load());
+    const qint64 created = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto tokenTime = [&](int index) {
+        if (options.tokensPerSec <= 0) {
+            return start;
+        }
+        return start + std::chrono::microseconds(std::int64_t(index * 1e6 / options.tokensPerSec));
+    };
+
+    if (!body.value("stream").toBool()) {
+        std::string content;
+        for (int i = 0; i < count; ++i) {
+            content += token(i);
+        }
+        std::this_thread::sleep_until(tokenTime(count));
+        sendJson(socket, request, http::status::ok, QJsonObject{
+            {"id", id}, {"object", "chat.completion"}, {"created", created}, {"model", model},
+            {"choices", QJsonArray{QJsonObject{
+                {"index", 0},
+                {"message", QJsonObject{{"role", "assistant"}, {"content", QString::fromStdString(content)}}},
+                {"finish_reason", count < options.tokens ? "length" : "stop"}}}},
+            {"usage", QJsonObject{{"prompt_tokens", qint64(request.body().size() / 4)},
+                                  {"completion_tokens", count},
+                                  {"total_tokens", qint64(request.body().size() / 4) + count}}}
+        });
+        totals.tokens.fetch_add(std::uint64_t(count));
+        totals.completed.fetch_add(1);
+        return;
+    }
+
+    http::response<http::empty_body> response{http::status::ok, request.version()};
+    response.set(http::field::content_type, "text/event-stream");
+    response.set(http::field::cache_control, "no-cache");
+    response.keep_alive(request.keep_alive());
+    response.chunked(true);
+    http::response_serializer<http::empty_body> serializer{response};
+    http::write_header(socket, serializer);
+
+    const auto sendEvent = [&](const std::string& data) {
+        const std::string event = "data: " + data + "\n\n";
+        boost::asio::write(socket, http::make_chunk(boost::asio::buffer(event)));
+    };
+    const auto chunk = [&](const QJsonObject& delta, const QJsonValue& finishReason) {
+        return toText(QJsonObject{
+            {"id", id}, {"object", "chat.completion.chunk"}, {"created", created}, {"model", model},
+            {"choices", QJsonArray{QJsonObject{{"index", 0}, {"delta", delta}, {"finish_reason", finishReason}}}}
+        });
+    };
+
+    try {
+        sendEvent(chunk(QJsonObject{{"role", "assistant"}, {"content", ""}}, QJsonValue::Null));
+        for (int i = 0; i < count; ++i) {
+            std::this_thread::sleep_until(tokenTime(i));
+            sendEvent(chunk(QJsonObject{{"content", QString::fromStdString(token(i))}}, QJsonValue::Null));
+            totals.tokens.fetch_add(1);
+        }
+        sendEvent(chunk(QJsonObject{}, count < options.tokens ? "length" : "stop"));
+        sendEvent("[DONE]");
+        boost::asio::write(socket, http::make_chunk_last());
+    } catch (const beast::system_error&) {
+        totals.aborted.fetch_add(1);
+        throw;
+    }
+    totals.streamed.fetch_add(1);
+    totals.completed.fetch_add(1);
+}
+
+void session(tcp::socket socket, const Options& options, int id) {
+    std::mt19937 random(options.seed * 7919u + unsigned(id));
+    beast::flat_buffer buffer;
+
+    try {
+        // Keep-alive: QNetworkAccessManager reuses its connections
+        for (;;) {
+            http::request_parser<http::string_body> parser;
+            parser.body_limit(MAX_BODY_BYTES);
+            http::read(socket, buffer, parser);
+            const http::request<http::string_body> request = parser.release();
+
+            const std::string target(request.target());
+            if (request.method() == http::verb::get && target == "/health") {
+                sendJson(socket, request, http::status::ok, QJsonObject{{"status", "ok"}});
+            } else if (request.method() == http::verb::post &&
+                       target.size() >= 17 && target.compare(target.size() - 17, 17, "/chat/completions") == 0) {
+                answer(socket, request, options, random);
+            } else {
+                sendJson(socket, request, http::status::not_found,
+                         errorBody("Unknown endpoint " + QString::fromStdString(target), "invalid_request_error"));
+            }
+
+            if (!request.keep_alive()) {
+                break;
+            }
+        }
+        beast::error_code ec;
+        socket.shutdown(tcp::socket::shutdown_send, ec);
+    } catch (const beast::system_error& e) {
+        if (e.code() != http::error::end_of_stream && e.code() != boost::asio::error::connection_reset &&
+            e.code() != boost::asio::error::broken_pipe) {
+            log("[" + std::to_string(id) + "] " + e.code().message());
+        }
+    } catch (const std::exception& e) {
+        log("[" + std::to_string(id) + "] error: " + e.what());
+    }
+}
+
+void report() {
+    std::uint64_t lastRequests = 0;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const std::uint64_t requests = totals.requests.load();
+        if (requests == lastRequests && totals.inFlight.load() == 0) {
+            continue;
+        }
+        char line[320];
+        std::snprintf(line, sizeof(line),
+                      "%llu requests (+%llu/s), %d in flight (peak %d), %llu completed, %llu streamed, "
+                      "%llu tokens, %llu images (%.1f MB), 429: %llu, 500: %llu, 4xx: %llu, aborted: %llu",
+                      static_cast<unsigned long long>(requests),
+                      static_cast<unsigned long long>(requests - lastRequests),
+                      totals.inFlight.load(), totals.peakInFlight.load(),
+                      static_cast<unsigned long long>(totals.completed.load()),
+                      static_cast<unsigned long long>(totals.streamed.load()),
+                      static_cast<unsigned long long>(totals.tokens.load()),
+                      static_cast<unsigned long long>(totals.images.load()),
+                      totals.imageBytes.load() / 1e6,
+                      static_cast<unsigned long long>(totals.rateLimited.load()),
+                      static_cast<unsigned long long>(totals.serverErrors.load()),
+                      static_cast<unsigned long long>(totals.badRequests.load()),
+                      static_cast<unsigned long long>(totals.aborted.load()));
+        log(line);
+        lastRequests = requests;
+    }
+}
+
+bool parseDistribution(const std::string& name, LatencyDistribution& distribution) {
+    if (name == "fixed") {
+        distribution = LatencyDistribution::Fixed;
+    } else if (name == "uniform") {
+        distribution = LatencyDistribution::Uniform;
+    } else if (name == "exponential") {
+        distribution = LatencyDistribution::Exponential;
+    } else if (name == "lognormal") {
+        distribution = LatencyDistribution::LogNormal;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const std::string value = argv[i + 1];
+        if (name == "--port") {
+            options.port = static_cast<unsigned short>(std::stoi(value));
+        } else if (name == "--latency-ms") {
+            options.latencyMs = std::max(std::stod(value), 0.001);
+        } else if (name == "--latency-dist") {
+            if (!parseDistribution(value, options.distribution)) {
+                std::cerr << "Unknown latency distribution " << value << std::endl;
+                return 1;
+            }
+        } else if (name == "--latency-spread") {
+            options.spread = std::max(std::stod(value), 0.0);
+        } else if (name == "--tokens") {
+            options.tokens = std::max(std::stoi(value), 1);
+        } else if (name == "--tokens-per-sec") {
+            options.tokensPerSec = std::stod(value);
+        } else if (name == "--error-rate") {
+            options.errorRate = std::stod(value);
+        } else if (name == "--rate-limit") {
+            options.rateLimit = std::stod(value);
+        } else if (name == "--max-concurrent") {
+            options.maxConcurrent = std::stoi(value);
+        } else if (name == "--images") {
+            options.acceptImages = value != "reject";
+        } else if (name == "--require-key") {
+            options.requireKey = value != "no";
+        } else if (name == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(value));
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+
+    boost::asio::io_context ioContext;
+    tcp::acceptor acceptor(ioContext, {tcp::v4(), options.port});
+    log("Listening on port " + std::to_string(options.port) +
+        ", POST /v1/chat/completions");
+
+    std::thread(report).detach();
+
+    for (int id = 1;; ++id) {
+        tcp::socket socket(ioContext);
+        acceptor.accept(socket);
+        socket.set_option(tcp::no_delay(true));
+        std::thread(session, std::move(socket), std::cref(options), id).detach();
+    }
+}
@@ -0,0 +1,301 @@
+// Stand-in for the transcription server, for testing the audio transport
+// without a GPU box. It speaks the protocol described in
+// TranscriptionClient.h, decodes every audio message, checks it and
+// reports what arrived.
+//
+// Usage: qhyni_mock_transcription [--port 8765] [--codec ima-adpcm|mulaw|pcm16]
+//                                 [--wav out.wav] [--transcribe-every 2.0]
+//                                 [--resume yes|no]
+//
+// --codec limits what the server accepts during negotiation, --wav writes
+// the decoded audio of the last connection for listening, and a fake
+// "transcribe" message is sent back for every N seconds of audio so the
+// app's transcript view shows activity. Streams are resumed unless
+// --resume no is given: numbered audio the server already received on an
+// earlier connection is counted as duplicate and dropped, and holes in the
+// numbering are reported as lost audio. Killing and restarting the server
+// shows what a restart costs.
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioCodec.h"
+
+namespace beast = boost::beast;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+struct Options {
+    unsigned short port{8765};
+    std::string codec;     // empty: accept the client's first choice
+    std::string wavPath;
+    double transcribeEvery{2.0};
+    bool resume{true};
+};
+
+std::mutex outputMutex;
+
+// Last audio message received per stream, across connections
+std::mutex streamsMutex;
+std::map<std::string, std::uint64_t> lastSeqByStream;
+
+void log(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+class WavWriter
+{
+public:
+    WavWriter(const std::string& path, int sampleRate)
+        : m_file(path, std::ios::binary), m_sampleRate(sampleRate)
+    {
+        writeHeader();
+    }
+
+    ~WavWriter() {
+        if (m_file) {
+            m_file.seekp(0);
+            writeHeader();
+        }
+    }
+
+    void write(const std::vector<std::int16_t>& samples) {
+        m_file.write(reinterpret_cast<const char*>(samples.data()),
+                     std::streamsize(samples.size() * sizeof(std::int16_t)));
+        m_dataBytes += std::uint32_t(samples.size() * sizeof(std::int16_t));
+    }
+
+private:
+    void put32(std::uint32_t value) { m_file.write(reinterpret_cast<const char*>(&value), 4); }
+    void put16(std::uint16_t value) { m_file.write(reinterpret_cast<const char*>(&value), 2); }
+
+    void writeHeader() {
+        m_file.write("RIFF", 4);
+        put32(36 + m_dataBytes);
+        m_file.write("WAVEfmt ", 8);
+        put32(16);
+        put16(1);                         // PCM
+        put16(1);                         // mono
+        put32(std::uint32_t(m_sampleRate));
+        put32(std::uint32_t(m_sampleRate * 2));
+        put16(2);
+        put16(16);
+        m_file.write("data", 4);
+        put32(m_dataBytes);
+    }
+
+    std::ofstream m_file;
+    int m_sampleRate;
+    std::uint32_t m_dataBytes{0};
+};
+
+std::string toText(const QJsonObject& object) {
+    return QJsonDocument(object).toJson(QJsonDocument::Compact).toStdString();
+}
+
+void session(tcp::socket socket, const Options& options, int id) {
+    const std::string tag = "[" + std::to_string(id) + "] ";
+
+    try {
+        websocket::stream<tcp::socket> ws(std::move(socket));
+        ws.accept();
+        log(tag + "connected");
+
+        AudioCodec codec = AudioCodec::Pcm16;
+        int sampleRate = 16000;
+        std::unique_ptr<WavWriter> wav;
+
+        std::uint64_t messages = 0;
+        std::uint64_t wireBytes = 0;
+        std::uint64_t samples = 0;
+        std::uint64_t errors = 0;
+        std::uint64_t samplesAtLastTranscript = 0;
+        std::uint64_t duplicates = 0;
+        std::uint64_t missing = 0;
+        std::vector<std::int16_t> decoded;
+
+        std::string stream;
+        std::uint64_t nextSeq = 0;  // 0 while the audio is not numbered
+
+        const auto start = std::chrono::steady_clock::now();
+        auto lastReport = start;
+
+        auto report = [&]() {
+            char line[240];
+            std::snprintf(line, sizeof(line),
+                          "%s%llu msgs, %.1f s audio, %llu wire bytes, %.2f:1 vs pcm16, %llu errors, "
+                          "%llu duplicates, %llu lost",
+                          tag.c_str(), static_cast<unsigned long long>(messages),
+                          double(samples) / sampleRate, static_cast<unsigned long long>(wireBytes),
+                          wireBytes ? double(samples * 2) / double(wireBytes) : 0.0,
+                          static_cast<unsigned long long>(errors),
+                          static_cast<unsigned long long>(duplicates),
+                          static_cast<unsigned long long>(missing));
+            log(line);
+        };
+
+        beast::flat_buffer buffer;
+        try {
+            for (;;) {
+                buffer.clear();
+                ws.read(buffer);
+                const auto* data = static_cast<const std::uint8_t*>(buffer.data().data());
+                const std::size_t bytes = buffer.size();
+
+                if (ws.got_text()) {
+                    const std::string text(reinterpret_cast<const char*>(data), bytes);
+                    const QJsonObject message = QJsonDocument::fromJson(QByteArray::fromStdString(text)).object();
+                    const QString type = message.value("type").toString();
+
+                    if (type == "hello") {
+                        // Pick the client's most preferred codec we accept
+                        std::string chosen = "pcm16";
+                        for (const auto& value : message.value("codecs").toArray()) {
+                            const std::string name = value.toString().toStdString();
+                            AudioCodec candidate;
+                            if (audioCodecFromName(name, candidate) &&
+                                (options.codec.empty() || options.codec == name)) {
+                                chosen = name;
+                                break;
+                            }
+                        }
+                        sampleRate = message.value("sample_rate").toInt(16000);
+                        QJsonObject reply{{"type", "hello"}, {"codec", QString::fromStdString(chosen)}};
+                        if (options.resume && message.value("resume").toBool()) {
+                            reply.insert("resume", true);
+                        }
+                        ws.text(true);
+                        ws.write(boost::asio::buffer(toText(reply)));
+                        log(tag + "hello: " + text + " -> " + toText(reply));
+                    } else if (type == "audio_resume") {
+                        stream = message.value("stream").toString().toStdString();
+                        nextSeq = std::uint64_t(message.value("seq").toInteger());
+                        log(tag + "stream " + stream + " resumes at " + std::to_string(nextSeq));
+                    } else if (type == "audio_codec") {
+                        const std::string name = message.value("codec").toString().toStdString();
+                        if (!audioCodecFromName(name, codec)) {
+                            ++errors;
+                            log(tag + "ERROR unknown codec announced: " + name);
+                        } else {
+                            log(tag + "audio now " + name);
+                        }
+                    } else {
+                        log(tag + "text: " + text);
+                    }
+                    continue;
+                }
+
+                ++messages;
+                wireBytes += bytes;
+
+                if (nextSeq != 0) {
+                    const std::uint64_t seq = nextSeq++;
+                    std::lock_guard<std::mutex> lock(streamsMutex);
+                    std::uint64_t& last = lastSeqByStream[stream];
+                    if (seq <= last) {
+                        ++duplicates;
+                        continue;
+                    }
+                    if (last != 0 && seq > last + 1) {
+                        missing += seq - last - 1;
+                        log(tag + "LOST messages " + std::to_string(last + 1) + " to " + std::to_string(seq - 1));
+                    }
+                    last = seq;
+                }
+                if (!AudioDecoder::decode(codec, data, bytes, decoded) || decoded.empty()) {
+                    ++errors;
+                    log(tag + "ERROR malformed " + audioCodecName(codec) + " message of " +
+                        std::to_string(bytes) + " bytes");
+                    continue;
+                }
+                samples += decoded.size();
+
+                if (!options.wavPath.empty()) {
+                    if (!wav) {
+                        wav = std::make_unique<WavWriter>(options.wavPath, sampleRate);
+                    }
+                    wav->write(decoded);
+                }
+
+                const double audioSeconds = double(samples - samplesAtLastTranscript) / sampleRate;
+                if (options.transcribeEvery > 0 && audioSeconds >= options.transcribeEvery) {
+                    samplesAtLastTranscript = samples;
+                    char content[160];
+                    std::snprintf(content, sizeof(content), "[stand-in] %.1f s of audio received (%s, %.2f:1)",
+                                  double(samples) / sampleRate, audioCodecName(codec),
+                                  double(samples * 2) / double(wireBytes));
+                    ws.text(true);
+                    ws.write(boost::asio::buffer(toText({{"type", "transcribe"}, {"content", content}})));
+                }
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now - lastReport >= std::chrono::seconds(1)) {
+                    lastReport = now;
+                    report();
+                }
+            }
+        } catch (const beast::system_error&) {
+            report();  // totals of the whole connection
+            throw;
+        }
+    } catch (const beast::system_error& e) {
+        if (e.code() != websocket::error::closed) {
+            log(tag + "disconnected: " + e.code().message());
+        } else {
+            log(tag + "closed");
+        }
+    } catch (const std::exception& e) {
+        log(tag + "error: " + e.what());
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const std::string value = argv[i + 1];
+        if (name == "--port") {
+            options.port = static_cast<unsigned short>(std::stoi(value));
+        } else if (name == "--codec") {
+            options.codec = value;
+        } else if (name == "--wav") {
+            options.wavPath = value;
+        } else if (name == "--transcribe-every") {
+            options.transcribeEvery = std::stod(value);
+        } else if (name == "--resume") {
+            options.resume = value != "no";
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+
+    boost::asio::io_context ioContext;
+    tcp::acceptor acceptor(ioContext, {tcp::v4(), options.port});
+    log("Listening on port " + std::to_string(options.port));
+
+    for (int id = 1;; ++id) {
+        tcp::socket socket(ioContext);
+        acceptor.accept(socket);
+        std::thread(session, std::move(socket), std::cref(options), id).detach();
+    }
+}